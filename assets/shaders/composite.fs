@@ -0,0 +1,45 @@
+// Final pass of a frame: pixelizes the playfield when asked to and puts the UI on top of it
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+// Playfield, the texture coordinates only cover the part of it that was rendered to
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+
+uniform sampler2D uiTexture;
+uniform vec2 screenSize;
+
+// Size of a pixelized block in playfield texture coordinates, 0 leaves the playfield as it is
+uniform vec2 pixelSize;
+
+// Passes culled this frame, a missing playfield shows the background color instead
+uniform int playfieldEnabled;
+uniform int uiEnabled;
+uniform vec4 background;
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    vec3 color = background.rgb;
+    if (playfieldEnabled != 0) {
+        vec2 coord = fragTexCoord;
+        if (pixelSize.x > 0.0) {
+            coord = pixelSize*floor(coord/pixelSize);
+        }
+        color = texture(texture0, coord).rgb;
+    }
+
+    // The UI buffer covers the whole screen and is upside down just like the screen, so fragment coordinates
+    // can be used as they are
+    if (uiEnabled != 0) {
+        vec4 ui = texture(uiTexture, gl_FragCoord.xy/screenSize);
+        color = mix(color, ui.rgb, ui.a);
+    }
+
+    finalColor = vec4(color, 1.0);
+}
@@ -1,5 +1,7 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
+#include "stdbool.h"
 #include "stdint.h"
 #include "stdio.h"
 #include "stdlib.h"
@@ -82,44 +84,462 @@ Ray GetScreenToWorldPointWithZDistance(Vector2 position, Camera camera, int scre
     return ray;
 }
 
-static inline Clay_Dimensions Raylib_MeasureText(Clay_StringSlice text, Clay_TextElementConfig *config,
-                                                 void *userData) {
-    // Measure string size for Font
-    Clay_Dimensions textSize = {0};
+// raylib's default spacing between lines of text
+#define RAYLIB_TEXT_LINE_SPACING 2
 
-    float maxTextWidth = 0.0f;
-    float lineTextWidth = 0;
+// FNV-1a, continues from `hash`
+static inline uint64_t Raylib_HashBytes(uint64_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+#define RAYLIB_HASH_OFFSET 0xcbf29ce484222325ull
 
-    float textHeight = config->fontSize;
-    Font *fonts = (Font *)userData;
-    Font fontToUse = fonts[config->fontId];
+static inline Font Raylib_FontOrDefault(Font font) {
     // Font failed to load, likely the fonts are in the wrong place relative to the execution dir.
     // RayLib ships with a default font, so we can continue with that built in one.
-    if (!fontToUse.glyphs) {
-        fontToUse = GetFontDefault();
+    return font.glyphs ? font : GetFontDefault();
+}
+
+// Decodes the codepoint at `chars[*i]` without reading past `length`, advances `*i`
+static inline int Raylib_NextCodepoint(const char *chars, int length, int *i) {
+    if ((unsigned char)chars[*i] < 0x80) {
+        return chars[(*i)++];
+    }
+    // GetCodepointNext wants a terminated string, a copy of at most 4 bytes is enough for any codepoint
+    char sequence[5] = {0};
+    for (int k = 0; k < 4 && *i + k < length; k++) {
+        sequence[k] = chars[*i + k];
+    }
+    int size = 1;
+    const int codepoint = GetCodepointNext(sequence, &size);
+    *i += size;
+    return codepoint;
+}
+
+// Same as `DrawTextEx` but straight from a slice, no terminated copy needed
+static void Raylib_DrawTextSlice(Font font, Clay_StringSlice text, Vector2 position, float fontSize, float spacing,
+                                 Color tint) {
+    font = Raylib_FontOrDefault(font);
+    const float scaleFactor = fontSize / font.baseSize;
+    float offsetX = 0;
+    float offsetY = 0;
+    for (int i = 0; i < text.length;) {
+        const int codepoint = Raylib_NextCodepoint(text.chars, text.length, &i);
+        if (codepoint == '\n') {
+            offsetY += fontSize + RAYLIB_TEXT_LINE_SPACING;
+            offsetX = 0;
+            continue;
+        }
+        const int index = GetGlyphIndex(font, codepoint);
+        if (codepoint != ' ' && codepoint != '\t') {
+            DrawTextCodepoint(font, codepoint, (Vector2){position.x + offsetX, position.y + offsetY}, fontSize, tint);
+        }
+        if (font.glyphs[index].advanceX == 0) {
+            offsetX += font.recs[index].width * scaleFactor + spacing;
+        } else {
+            offsetX += font.glyphs[index].advanceX * scaleFactor + spacing;
+        }
+    }
+}
+
+// Size `Raylib_DrawTextSlice` covers, the same way `MeasureTextEx` works it out
+static Vector2 Raylib_MeasureTextSlice(Font font, Clay_StringSlice text, float fontSize, float spacing) {
+    font = Raylib_FontOrDefault(font);
+    const float scaleFactor = fontSize / font.baseSize;
+    float width = 0;
+    float lineWidth = 0;
+    int lines = 1;
+    for (int i = 0; i < text.length;) {
+        const int codepoint = Raylib_NextCodepoint(text.chars, text.length, &i);
+        if (codepoint == '\n') {
+            width = fmaxf(width, lineWidth);
+            lineWidth = 0;
+            lines++;
+            continue;
+        }
+        const int index = GetGlyphIndex(font, codepoint);
+        const float advance = font.glyphs[index].advanceX == 0 ? font.recs[index].width : font.glyphs[index].advanceX;
+        lineWidth += advance * scaleFactor + spacing;
+    }
+    width = fmaxf(width, lineWidth);
+    return (Vector2){width, lines * fontSize + (lines - 1) * RAYLIB_TEXT_LINE_SPACING};
+}
+
+// Measurements handed to Clay, which asks for every word of every text element on each layout. Repeated labels are
+// answered from an open addressing table, anything new is measured from a flat advance table of the font size
+#define RAYLIB_MEASURE_SLOTS 4096 // Power of two
+#define RAYLIB_MEASURE_MAX_ADVANCES 16
+#define RAYLIB_MAX_FONTS 8
+
+typedef struct {
+    uint64_t key; // 0 when the slot is free
+    Clay_Dimensions size;
+} Raylib_MeasuredText;
+
+// Scaled advances of codepoints 0-255 for one font at one size
+typedef struct {
+    uint16_t fontId;
+    uint16_t fontSize;
+    float advance[256];
+} Raylib_GlyphAdvances;
+
+typedef struct Raylib_TextMeasureCache {
+    Font fonts[RAYLIB_MAX_FONTS];
+    int fontCount;
+    Raylib_MeasuredText slots[RAYLIB_MEASURE_SLOTS];
+    size_t used;
+    Raylib_GlyphAdvances advances[RAYLIB_MEASURE_MAX_ADVANCES];
+    int advanceCount;
+    int nextAdvance; // Replaced next once all of `advances` are taken
+
+    size_t hits;
+    size_t misses;
+} Raylib_TextMeasureCache;
+
+// `fonts` are copied, they have to be loaded already
+Raylib_TextMeasureCache *Raylib_TextMeasureCache_New(const Font *fonts, int fontCount) {
+    Raylib_TextMeasureCache *cache = (Raylib_TextMeasureCache *)calloc(1, sizeof(Raylib_TextMeasureCache));
+    cache->fontCount = fontCount < RAYLIB_MAX_FONTS ? fontCount : RAYLIB_MAX_FONTS;
+    for (int i = 0; i < cache->fontCount; i++) {
+        cache->fonts[i] = Raylib_FontOrDefault(fonts[i]);
     }
+    return cache;
+}
+
+void Raylib_TextMeasureCache_Free(Raylib_TextMeasureCache *cache) {
+    free(cache);
+}
 
-    float scaleFactor = config->fontSize / (float)fontToUse.baseSize;
+static float Raylib_GlyphAdvance(Font font, int codepoint, float scaleFactor) {
+    const int index = GetGlyphIndex(font, codepoint);
+    if (font.glyphs[index].advanceX != 0) {
+        return font.glyphs[index].advanceX * scaleFactor;
+    }
+    return (font.recs[index].width + font.glyphs[index].offsetX) * scaleFactor;
+}
 
-    for (int i = 0; i < text.length; ++i) {
-        if (text.chars[i] == '\n') {
-            maxTextWidth = fmax(maxTextWidth, lineTextWidth);
+static const Raylib_GlyphAdvances *Raylib_TextMeasureCache_Advances(Raylib_TextMeasureCache *cache, Font font,
+                                                                    uint16_t fontId, uint16_t fontSize) {
+    for (int i = 0; i < cache->advanceCount; i++) {
+        if (cache->advances[i].fontId == fontId && cache->advances[i].fontSize == fontSize) {
+            return &cache->advances[i];
+        }
+    }
+    Raylib_GlyphAdvances *advances;
+    if (cache->advanceCount < RAYLIB_MEASURE_MAX_ADVANCES) {
+        advances = &cache->advances[cache->advanceCount++];
+    } else {
+        advances = &cache->advances[cache->nextAdvance];
+        cache->nextAdvance = (cache->nextAdvance + 1) % RAYLIB_MEASURE_MAX_ADVANCES;
+    }
+    advances->fontId = fontId;
+    advances->fontSize = fontSize;
+    const float scaleFactor = fontSize / (float)font.baseSize;
+    for (int c = 0; c < 256; c++) {
+        advances->advance[c] = Raylib_GlyphAdvance(font, c, scaleFactor);
+    }
+    return advances;
+}
+
+static Clay_Dimensions Raylib_MeasureTextUncached(Raylib_TextMeasureCache *cache, Clay_StringSlice text,
+                                                  Clay_TextElementConfig *config) {
+    const Font font = config->fontId < cache->fontCount ? cache->fonts[config->fontId] : GetFontDefault();
+    const Raylib_GlyphAdvances *advances =
+        Raylib_TextMeasureCache_Advances(cache, font, config->fontId, config->fontSize);
+    const float scaleFactor = config->fontSize / (float)font.baseSize;
+
+    float maxTextWidth = 0;
+    float lineTextWidth = 0;
+    int lineGlyphs = 0;
+    for (int i = 0; i < text.length;) {
+        const int codepoint = Raylib_NextCodepoint(text.chars, text.length, &i);
+        if (codepoint == '\n') {
+            maxTextWidth = fmaxf(maxTextWidth, lineTextWidth);
             lineTextWidth = 0;
+            lineGlyphs = 0;
             continue;
         }
-        int index = text.chars[i] - 32;
-        if (fontToUse.glyphs[index].advanceX != 0)
-            lineTextWidth += fontToUse.glyphs[index].advanceX;
-        else
-            lineTextWidth += (fontToUse.recs[index].width + fontToUse.glyphs[index].offsetX);
+        if (lineGlyphs++ > 0) {
+            lineTextWidth += config->letterSpacing;
+        }
+        lineTextWidth += codepoint < 256 ? advances->advance[codepoint]
+                                         : Raylib_GlyphAdvance(font, codepoint, scaleFactor);
+    }
+    maxTextWidth = fmaxf(maxTextWidth, lineTextWidth);
+    return (Clay_Dimensions){maxTextWidth, config->fontSize};
+}
+
+// Measure function for `Clay_SetMeasureTextFunction`, `userData` is a `Raylib_TextMeasureCache`
+static inline Clay_Dimensions Raylib_MeasureText(Clay_StringSlice text, Clay_TextElementConfig *config,
+                                                 void *userData) {
+    Raylib_TextMeasureCache *cache = (Raylib_TextMeasureCache *)userData;
+    const uint16_t style[] = {config->fontId, config->fontSize, config->letterSpacing};
+    const uint64_t key =
+        Raylib_HashBytes(Raylib_HashBytes(RAYLIB_HASH_OFFSET, text.chars, text.length), style, sizeof(style)) | 1;
+
+    const size_t mask = RAYLIB_MEASURE_SLOTS - 1;
+    size_t i = key & mask;
+    for (; cache->slots[i].key != 0; i = (i + 1) & mask) {
+        if (cache->slots[i].key == key) {
+            cache->hits++;
+            return cache->slots[i].size;
+        }
+    }
+    cache->misses++;
+    const Clay_Dimensions size = Raylib_MeasureTextUncached(cache, text, config);
+    // Never fuller than 3/4 so probes stay short, nothing is evicted on its own so start over instead
+    if (cache->used >= RAYLIB_MEASURE_SLOTS / 4 * 3) {
+        memset(cache->slots, 0, sizeof(cache->slots));
+        cache->used = 0;
+        i = key & mask;
+    }
+    cache->slots[i] = (Raylib_MeasuredText){.key = key, .size = size};
+    cache->used++;
+    return size;
+}
+
+// Rasterized text runs, packed into shelves of a render texture. When it is full the least recently used shelf is
+// thrown out as a whole
+#define RAYLIB_TEXT_ATLAS_SIZE 2048
+#define RAYLIB_TEXT_ATLAS_MAX_SHELVES 128
+// Power of two, open addressing with linear probing
+#define RAYLIB_TEXT_ATLAS_SLOTS 1024
+// Never more runs than this in the table, keeps probe sequences short and guarantees they end at a free slot
+#define RAYLIB_TEXT_ATLAS_MAX_RUNS (RAYLIB_TEXT_ATLAS_SLOTS * 3 / 4)
+// Runs taller than this are drawn directly, they'd waste most of a shelf
+#define RAYLIB_TEXT_ATLAS_MAX_RUN_HEIGHT 256
+
+typedef struct {
+    uint64_t key; // 0 when the slot is free
+    Rectangle rect;
+    uint16_t shelf;
+} Raylib_TextAtlasRun;
+
+typedef struct {
+    int y;
+    int height;
+    int cursor;
+    uint64_t lastUsed;
+} Raylib_TextAtlasShelf;
+
+typedef struct Raylib_TextAtlas {
+    RenderTexture2D texture;
+    Raylib_TextAtlasRun slots[RAYLIB_TEXT_ATLAS_SLOTS];
+    Raylib_TextAtlasShelf shelves[RAYLIB_TEXT_ATLAS_MAX_SHELVES];
+    int shelfCount;
+    int nextShelfY;
+    size_t runCount; // Occupied slots
+    uint64_t frame;
+    bool drawing; // Inside of the atlas' texture mode, only while preparing
+
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+} Raylib_TextAtlas;
+
+Raylib_TextAtlas *Raylib_TextAtlas_Load(void) {
+    Raylib_TextAtlas *atlas = (Raylib_TextAtlas *)calloc(1, sizeof(Raylib_TextAtlas));
+    atlas->texture = LoadRenderTexture(RAYLIB_TEXT_ATLAS_SIZE, RAYLIB_TEXT_ATLAS_SIZE);
+    SetTextureFilter(atlas->texture.texture, TEXTURE_FILTER_POINT);
+    return atlas;
+}
+
+void Raylib_TextAtlas_Unload(Raylib_TextAtlas *atlas) {
+    UnloadRenderTexture(atlas->texture);
+    free(atlas);
+}
+
+static uint64_t Raylib_TextAtlas_Key(Clay_TextRenderData *text) {
+    const uint64_t hash =
+        Raylib_HashBytes(RAYLIB_HASH_OFFSET, text->stringContents.chars, text->stringContents.length);
+    const uint32_t style[] = {text->fontId, text->fontSize, text->letterSpacing,
+                              ((uint32_t)text->textColor.r << 24) | ((uint32_t)text->textColor.g << 16) |
+                                  ((uint32_t)text->textColor.b << 8) | (uint32_t)text->textColor.a};
+    // 0 marks free slots
+    return Raylib_HashBytes(hash, style, sizeof(style)) | 1;
+}
+
+static Raylib_TextAtlasRun *Raylib_TextAtlas_Find(Raylib_TextAtlas *atlas, uint64_t key) {
+    for (size_t i = key & (RAYLIB_TEXT_ATLAS_SLOTS - 1);; i = (i + 1) & (RAYLIB_TEXT_ATLAS_SLOTS - 1)) {
+        if (atlas->slots[i].key == key) {
+            return &atlas->slots[i];
+        }
+        if (atlas->slots[i].key == 0) {
+            return NULL;
+        }
+    }
+}
+
+// Backward shift deletion, keeps probe sequences intact without tombstones
+static void Raylib_TextAtlas_Remove(Raylib_TextAtlas *atlas, size_t slot) {
+    const size_t mask = RAYLIB_TEXT_ATLAS_SLOTS - 1;
+    size_t hole = slot;
+    for (size_t i = (hole + 1) & mask; atlas->slots[i].key != 0; i = (i + 1) & mask) {
+        const size_t home = atlas->slots[i].key & mask;
+        // Entry `i` can fill the hole if its home isn't cyclically in (hole, i]
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            atlas->slots[hole] = atlas->slots[i];
+            hole = i;
+        }
+    }
+    atlas->slots[hole].key = 0;
+    atlas->runCount--;
+}
+
+// Drops every run of `shelf`, its whole row is free again afterwards
+static void Raylib_TextAtlas_EvictShelf(Raylib_TextAtlas *atlas, int shelf) {
+    for (size_t i = 0; i < RAYLIB_TEXT_ATLAS_SLOTS;) {
+        if (atlas->slots[i].key != 0 && atlas->slots[i].shelf == shelf) {
+            // Something else may have been shifted into `i`, look at it again
+            Raylib_TextAtlas_Remove(atlas, i);
+        } else {
+            i++;
+        }
+    }
+    atlas->shelves[shelf].cursor = 0;
+    atlas->evictions++;
+}
+
+// The least recently used shelf that is at least `height` tall and wasn't needed this frame, -1 if there is none
+// With `withRuns` empty shelves are skipped, evicting them wouldn't free any slots
+static int Raylib_TextAtlas_OldestShelf(Raylib_TextAtlas *atlas, int height, bool withRuns) {
+    int oldest = -1;
+    for (int i = 0; i < atlas->shelfCount; i++) {
+        const Raylib_TextAtlasShelf *s = &atlas->shelves[i];
+        if (s->height >= height && (!withRuns || s->cursor > 0) && s->lastUsed < atlas->frame &&
+            (oldest < 0 || s->lastUsed < atlas->shelves[oldest].lastUsed)) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+static void Raylib_ClearRegion(Rectangle region, Color color) {
+    BeginScissorMode(region.x, region.y, region.width, region.height);
+    ClearBackground(color);
+    EndScissorMode();
+}
+
+// Finds room for a `width` x `height` run, evicting the least recently used shelf if it has to
+static bool Raylib_TextAtlas_Allocate(Raylib_TextAtlas *atlas, int width, int height, Rectangle *rect,
+                                      uint16_t *shelf) {
+    // Rounded up so that runs of similar sizes share shelves
+    height = (height + 7) & ~7;
+    for (int i = 0; i < atlas->shelfCount; i++) {
+        Raylib_TextAtlasShelf *s = &atlas->shelves[i];
+        if (s->height >= height && s->height <= height + height / 2 && s->cursor + width <= RAYLIB_TEXT_ATLAS_SIZE) {
+            *rect = (Rectangle){s->cursor, s->y, width, height};
+            *shelf = i;
+            s->cursor += width;
+            return true;
+        }
+    }
+    if (atlas->shelfCount < RAYLIB_TEXT_ATLAS_MAX_SHELVES && atlas->nextShelfY + height <= RAYLIB_TEXT_ATLAS_SIZE) {
+        atlas->shelves[atlas->shelfCount] = (Raylib_TextAtlasShelf){.y = atlas->nextShelfY, .height = height};
+        atlas->nextShelfY += height;
+        atlas->shelfCount++;
+        return Raylib_TextAtlas_Allocate(atlas, width, height, rect, shelf);
     }
 
-    maxTextWidth = fmax(maxTextWidth, lineTextWidth);
+    // Full, reuse the least recently used shelf that is tall enough and wasn't needed this frame
+    const int oldest = Raylib_TextAtlas_OldestShelf(atlas, height, false);
+    if (oldest < 0) {
+        return false;
+    }
+    Raylib_TextAtlas_EvictShelf(atlas, oldest);
+    *rect = (Rectangle){0, atlas->shelves[oldest].y, width, atlas->shelves[oldest].height};
+    *shelf = oldest;
+    atlas->shelves[oldest].cursor = width;
+    return true;
+}
 
-    textSize.width = maxTextWidth * scaleFactor;
-    textSize.height = textHeight;
+// Rasterizes every text run of `renderCommands` that isn't in the atlas yet. Has to be called outside of any
+// texture mode, before the commands are rendered
+void Clay_Raylib_PrepareText(Raylib_TextAtlas *atlas, Clay_RenderCommandArray renderCommands, Font *fonts) {
+    atlas->frame++;
+    for (int j = 0; j < renderCommands.length; j++) {
+        Clay_RenderCommand *renderCommand = Clay_RenderCommandArray_Get(&renderCommands, j);
+        if (renderCommand->commandType != CLAY_RENDER_COMMAND_TYPE_TEXT) {
+            continue;
+        }
+        Clay_TextRenderData *textData = &renderCommand->renderData.text;
+        const uint64_t key = Raylib_TextAtlas_Key(textData);
+        Raylib_TextAtlasRun *run = Raylib_TextAtlas_Find(atlas, key);
+        if (run) {
+            atlas->shelves[run->shelf].lastUsed = atlas->frame;
+            continue;
+        }
 
-    return textSize;
+        // Too many runs in the table, make room by evicting shelves or don't cache this one at all
+        while (atlas->runCount >= RAYLIB_TEXT_ATLAS_MAX_RUNS) {
+            const int oldest = Raylib_TextAtlas_OldestShelf(atlas, 0, true);
+            if (oldest < 0) {
+                break;
+            }
+            Raylib_TextAtlas_EvictShelf(atlas, oldest);
+        }
+        if (atlas->runCount >= RAYLIB_TEXT_ATLAS_MAX_RUNS) {
+            continue;
+        }
+
+        const Font font = fonts[textData->fontId];
+        const Vector2 size =
+            Raylib_MeasureTextSlice(font, textData->stringContents, textData->fontSize, textData->letterSpacing);
+        const int width = (int)ceilf(size.x) + 2;
+        const int height = (int)ceilf(size.y) + 2;
+        Rectangle rect;
+        uint16_t shelf;
+        if (width > RAYLIB_TEXT_ATLAS_SIZE || height > RAYLIB_TEXT_ATLAS_MAX_RUN_HEIGHT ||
+            !Raylib_TextAtlas_Allocate(atlas, width, height, &rect, &shelf)) {
+            continue;
+        }
+        atlas->misses++;
+        atlas->shelves[shelf].lastUsed = atlas->frame;
+        for (size_t i = key & (RAYLIB_TEXT_ATLAS_SLOTS - 1);; i = (i + 1) & (RAYLIB_TEXT_ATLAS_SLOTS - 1)) {
+            if (atlas->slots[i].key == 0) {
+                atlas->slots[i] = (Raylib_TextAtlasRun){.key = key, .rect = rect, .shelf = shelf};
+                atlas->runCount++;
+                break;
+            }
+        }
+
+        if (!atlas->drawing) {
+            BeginTextureMode(atlas->texture);
+            atlas->drawing = true;
+        }
+        // The run's color with no coverage, glyphs then only add coverage. What ends up in the atlas is exactly
+        // what blending the text over something would need
+        const Color color = CLAY_COLOR_TO_RAYLIB_COLOR(textData->textColor);
+        Raylib_ClearRegion(rect, (Color){color.r, color.g, color.b, 0});
+        rlSetBlendFactorsSeparate(RL_ONE, RL_ZERO, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+        BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+        Raylib_DrawTextSlice(font, textData->stringContents, (Vector2){rect.x + 1, rect.y + 1}, textData->fontSize,
+                             textData->letterSpacing, color);
+        EndBlendMode();
+    }
+    if (atlas->drawing) {
+        EndTextureMode();
+        atlas->drawing = false;
+    }
+}
+
+// Draws a text run from the atlas as a single quad, false if it isn't in there
+static bool Raylib_TextAtlas_Draw(Raylib_TextAtlas *atlas, Clay_TextRenderData *textData, Vector2 position) {
+    const Raylib_TextAtlasRun *run = Raylib_TextAtlas_Find(atlas, Raylib_TextAtlas_Key(textData));
+    if (!run) {
+        return false;
+    }
+    atlas->hits++;
+    // Render textures are upside down
+    const Rectangle source = {run->rect.x, RAYLIB_TEXT_ATLAS_SIZE - run->rect.y - run->rect.height, run->rect.width,
+                              -run->rect.height};
+    DrawTexturePro(atlas->texture.texture, source,
+                   (Rectangle){roundf(position.x) - 1, roundf(position.y) - 1, run->rect.width, run->rect.height},
+                   (Vector2){0, 0}, 0, WHITE);
+    return true;
 }
 
 void Clay_Raylib_Initialize(int width, int height, const char *title, unsigned int flags) {
@@ -128,22 +548,20 @@ void Clay_Raylib_Initialize(int width, int height, const char *title, unsigned i
     //    EnableEventWaiting();
 }
 
-void Clay_Raylib_Render(Clay_RenderCommandArray renderCommands, Font *fonts) {
+// `atlas` can be NULL, text is then drawn glyph by glyph
+void Clay_Raylib_Render(Clay_RenderCommandArray renderCommands, Font *fonts, Raylib_TextAtlas *atlas) {
     for (int j = 0; j < renderCommands.length; j++) {
         Clay_RenderCommand *renderCommand = Clay_RenderCommandArray_Get(&renderCommands, j);
         Clay_BoundingBox boundingBox = renderCommand->boundingBox;
         switch (renderCommand->commandType) {
         case CLAY_RENDER_COMMAND_TYPE_TEXT: {
-            // Raylib uses standard C strings so isn't compatible with cheap slices, we need to clone the string to
-            // append null terminator
             Clay_TextRenderData *textData = &renderCommand->renderData.text;
-            char *cloned = (char *)malloc(textData->stringContents.length + 1);
-            memcpy(cloned, textData->stringContents.chars, textData->stringContents.length);
-            cloned[textData->stringContents.length] = '\0';
-            Font fontToUse = fonts[textData->fontId];
-            DrawTextEx(fontToUse, cloned, (Vector2){boundingBox.x, boundingBox.y}, (float)textData->fontSize,
-                       (float)textData->letterSpacing, CLAY_COLOR_TO_RAYLIB_COLOR(textData->textColor));
-            free(cloned);
+            const Vector2 position = {boundingBox.x, boundingBox.y};
+            if (atlas == NULL || !Raylib_TextAtlas_Draw(atlas, textData, position)) {
+                Raylib_DrawTextSlice(fonts[textData->fontId], textData->stringContents, position,
+                                     (float)textData->fontSize, (float)textData->letterSpacing,
+                                     CLAY_COLOR_TO_RAYLIB_COLOR(textData->textColor));
+            }
             break;
         }
         case CLAY_RENDER_COMMAND_TYPE_IMAGE: {
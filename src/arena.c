@@ -0,0 +1,50 @@
+#include "arena.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+Arena arena_new(size_t capacity) {
+    return (Arena){.memory = malloc(capacity), .capacity = capacity};
+}
+
+void arena_reset(Arena *arena) {
+    arena->used = 0;
+    arena->failed = 0;
+}
+
+void *arena_alloc(Arena *arena, size_t size, size_t alignment) {
+    const uintptr_t base = (uintptr_t)arena->memory;
+    const uintptr_t start = (base + arena->used + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (start - base > arena->capacity || size > arena->capacity - (start - base)) {
+        arena->failed++;
+        return NULL;
+    }
+    arena->used = start - base + size;
+    arena->high_water = arena->used > arena->high_water ? arena->used : arena->high_water;
+    return (void *)start;
+}
+
+const char *arena_printf(Arena *arena, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    const char *str = arena_vprintf(arena, format, args);
+    va_end(args);
+    return str;
+}
+
+const char *arena_vprintf(Arena *arena, const char *format, va_list args) {
+    char *str = arena->memory + arena->used;
+    const size_t available = arena->capacity - arena->used;
+    const int len = vsnprintf(str, available, format, args);
+    if (len < 0 || (size_t)len >= available) {
+        arena->failed++;
+        return "";
+    }
+    // Only claimed once it's known to fit, `str` is already in place
+    return arena_alloc(arena, len + 1, 1);
+}
+
+void arena_free(Arena *arena) {
+    free(arena->memory);
+    *arena = (Arena){0};
+}
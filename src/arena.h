@@ -0,0 +1,30 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdalign.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// A bump allocator for data that lives until the next `arena_reset`, nothing is freed on its own
+typedef struct {
+    char *memory;
+    size_t capacity;
+    size_t used;
+    size_t high_water; // Most ever used between two resets
+    size_t failed;     // Allocations that didn't fit since the last reset
+} Arena;
+
+Arena arena_new(size_t capacity);
+// Everything allocated before is gone after this
+void arena_reset(Arena *arena);
+// NULL when the arena is full
+void *arena_alloc(Arena *arena, size_t size, size_t alignment);
+// Formats into the arena, an empty string when it doesn't fit
+const char *arena_printf(Arena *arena, const char *format, ...) __attribute__((format(printf, 2, 3)));
+const char *arena_vprintf(Arena *arena, const char *format, va_list args) __attribute__((format(printf, 2, 0)));
+void arena_free(Arena *arena);
+
+// Uninitialized scratch array of `count` elements of `type`
+#define arena_array(arena, type, count) ((type *)arena_alloc((arena), sizeof(type) * (count), alignof(type)))
+
+#endif
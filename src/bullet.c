@@ -8,43 +8,79 @@
 #include <stb_ds.h>
 
 void bullets_spawn_bullet(Bullets *bullets, Bullet b) {
+    // `direction` never changes, neither does the angle it is drawn at
+    const float length = Vector2Length(b.direction);
+    b.rotation = length > 0 ? Vector2Scale(b.direction, 1 / length) : (Vector2){1, 0};
     stbds_arrput(*bullets, b);
 }
 
+static const float bullet_knockback[BK_COUNT] = {
+    [BK_PISTOL] = 200,
+    [BK_AR] = 100,
+    [BK_SHOTGUN] = 100,
+    [BK_RANGER] = 200,
+};
+
+void bullet_hit(Bullet *bullet, PhysicsComp *victim_physics, HealthComp *victim_health) {
+    victim_health->current -= bullet->damage;
+    bullet->active = false;
+    victim_physics->velocity.x += bullet_knockback[bullet->kind] * bullet->direction.x;
+    victim_physics->velocity.y += bullet_knockback[bullet->kind] * bullet->direction.y;
+}
+
+// Casts the bullet against the stage for its whole lifetime
+static void bullet_resolve_impact(Bullet *bullet, const Stage *stage) {
+    const float range = bullet->speed * BULLET_LIFETIME;
+    bullet->impact_resolved = true;
+    bullet->hits_stage = true;
+    bullet->impact_distance = 0;
+    if (stage_overlap_mask(stage, bullet->transform.rect) != 0) {
+        return;
+    }
+    StageHit hit;
+    bullet->hits_stage =
+        stage_sweep_rect(stage, bullet->transform.rect, Vector2Scale(bullet->direction, range), stage->count, &hit);
+    bullet->impact_distance = bullet->hits_stage ? hit.t * range : range;
+}
+
 void bullets_update(Bullets *bullets, float dt, const Stage *stage, Particles *particles) {
     for (ptrdiff_t i = 0; i < stbds_arrlen(*bullets); i++) {
         Bullet *bullet = &(*bullets)[i];
-        if (bullet->active) {
-            for (size_t j = 0; j < stage->count; j++) {
-                // If we collide with ANY of the platforms just die and spawn particles yippie
-                if (CheckCollisionRecs(stage->platforms[j], bullet->transform.rect)) {
-                    particles_spawn_n_in_dir(particles, 5, bullet->draw_conf.color,
-                                             Vector2Rotate(bullet->direction, PI), *(Vector2 *)&bullet->transform);
-                    bullet->active = false;
-                    break;
-                }
-            }
+        if (!bullet->active) {
+            continue;
+        }
+        if (!bullet->impact_resolved) {
+            bullet_resolve_impact(bullet, stage);
+        }
 
-            if (!bullet->active) {
-                continue;
-            }
-            const Vector2 movement_delta = Vector2Scale(bullet->direction, dt * bullet->speed);
-            const Vector2 next_pos =
-                Vector2Add(movement_delta, (Vector2){bullet->transform.rect.x, bullet->transform.rect.y});
+        float step = dt * bullet->speed;
+        const bool dies = bullet->travelled + step >= bullet->impact_distance;
+        if (dies) {
+            step = bullet->impact_distance - bullet->travelled;
+        }
+        bullet->travelled += step;
+        const Vector2 next_pos = Vector2Add(Vector2Scale(bullet->direction, step),
+                                            (Vector2){bullet->transform.rect.x, bullet->transform.rect.y});
+        bullet->transform.rect.x = next_pos.x;
+        bullet->transform.rect.y = next_pos.y;
 
-            bullet->transform.rect.x = next_pos.x;
-            bullet->transform.rect.y = next_pos.y;
+        if (dies) {
+            // Hit a platform, just die and spawn particles yippie
+            if (bullet->hits_stage) {
+                particles_spawn_n_in_dir(particles, 5, bullet->draw_conf.color, Vector2Rotate(bullet->direction, PI),
+                                         *(Vector2 *)&bullet->transform);
+            }
+            bullet->active = false;
         }
     }
 }
-void bullets_draw(const Bullets *bullets) {
+void bullets_draw(const Bullets *bullets, RectBatch *batch) {
     for (ptrdiff_t i = 0; i < stbds_arrlen(*bullets); i++) {
         if ((*bullets)[i].active) {
             Rectangle rect = (*bullets)[i].transform.rect;
             const Vector2 origin = {.x = rect.width / 2.0f, .y = rect.height / 2.0f};
 
-            DrawRectanglePro(rect, origin, atan2((*bullets)[i].direction.y, (*bullets)[i].direction.x) * RAD2DEG,
-                             (*bullets)[i].draw_conf.color);
+            rect_batch_push_rotated(batch, rect, origin, (*bullets)[i].rotation, (*bullets)[i].draw_conf.color);
         }
     }
 }
@@ -6,22 +6,39 @@
 
 #define BULLET_LIFETIME 2.0
 
+// Who fired a bullet, decides what a hit does
+typedef enum {
+    BK_PISTOL,
+    BK_AR,
+    BK_SHOTGUN,
+    BK_RANGER,
+    BK_COUNT,
+} BulletKind;
+
 typedef struct Bullet {
     TransformComp transform;
     SolidRectangleComp draw_conf;
     Vector2 direction;
+    Vector2 rotation; // (cos, sin) of `direction`'s angle, set on spawn
     double speed;
     double creation_time;
     int damage;
     bool active;
-    void (*on_hit)(struct Bullet* this, PhysicsComp* victim_physics, HealthComp* victim_health);
+    // Bullets fly in a straight line through a static stage, so where they hit it is only worked out once
+    bool impact_resolved;
+    bool hits_stage;
+    float impact_distance;
+    float travelled;
+    BulletKind kind;
 } Bullet;
 
 typedef Bullet* Bullets;
 
 void bullets_spawn_bullet(Bullets *bullets, Bullet b);
+// Damages and knocks back whatever `bullet` hit, the bullet is used up
+void bullet_hit(Bullet *bullet, PhysicsComp *victim_physics, HealthComp *victim_health);
 
 void bullets_update(Bullets *bullets, float dt, const Stage *stage, Particles *particles);
-void bullets_draw(const Bullets *bullets);
+void bullets_draw(const Bullets *bullets, RectBatch *batch);
 
 #endif
@@ -0,0 +1,60 @@
+#include "drs.h"
+#include "raymath.h"
+
+DynamicResolution drs_new() {
+    return (DynamicResolution){
+        .enabled = true,
+        .fraction = DRS_MAX_FRACTION,
+        .frame_time = DRS_TARGET_FRAME_TIME,
+        .work_time = DRS_TARGET_FRAME_TIME,
+    };
+}
+
+bool drs_update(DynamicResolution *drs, float frame_time, float work_time) {
+    drs->frame_time = Lerp(drs->frame_time, frame_time, 0.1f);
+    drs->work_time = Lerp(drs->work_time, work_time, 0.1f);
+    if (!drs->enabled) {
+        const bool changed = drs->fraction != DRS_MAX_FRACTION;
+        drs->fraction = DRS_MAX_FRACTION;
+        return changed;
+    }
+
+    // Anything between the two thresholds resets both counters, that gap is what keeps it from oscillating
+    if (drs->frame_time > DRS_TARGET_FRAME_TIME * DRS_OVER_BUDGET) {
+        drs->over_frames++;
+        drs->under_frames = 0;
+    } else if (drs->work_time < DRS_TARGET_FRAME_TIME * DRS_UNDER_BUDGET) {
+        drs->under_frames++;
+        drs->over_frames = 0;
+    } else {
+        drs->over_frames = 0;
+        drs->under_frames = 0;
+    }
+
+    float next = drs->fraction;
+    if (drs->over_frames >= DRS_DOWN_FRAMES) {
+        next = Clamp(drs->fraction - DRS_STEP, DRS_MIN_FRACTION, DRS_MAX_FRACTION);
+    } else if (drs->under_frames >= DRS_UP_FRAMES) {
+        next = Clamp(drs->fraction + DRS_STEP, DRS_MIN_FRACTION, DRS_MAX_FRACTION);
+    }
+    if (next == drs->fraction) {
+        // Already at the limit, nothing left to decide
+        if (drs->over_frames >= DRS_DOWN_FRAMES || drs->under_frames >= DRS_UP_FRAMES) {
+            drs->over_frames = 0;
+            drs->under_frames = 0;
+        }
+        return false;
+    }
+    if (next < drs->fraction) {
+        drs->downscales++;
+    } else {
+        drs->upscales++;
+    }
+    drs->fraction = next;
+    drs->over_frames = 0;
+    drs->under_frames = 0;
+    // The smoothed times still describe the old resolution, start over from the target
+    drs->frame_time = DRS_TARGET_FRAME_TIME;
+    drs->work_time = DRS_TARGET_FRAME_TIME;
+    return true;
+}
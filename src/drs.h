@@ -0,0 +1,37 @@
+#ifndef DRS_H
+#define DRS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Fraction of the playfield buffer (per axis) actually rendered to
+#define DRS_MIN_FRACTION 0.5f
+#define DRS_MAX_FRACTION 1.0f
+#define DRS_STEP 0.1f
+#define DRS_TARGET_FRAME_TIME (1.0f / 60.0f)
+// Frames have to miss the target by this much before resolution is dropped...
+#define DRS_OVER_BUDGET 1.1f
+// ...and the work of a frame has to fit this far under it before resolution is raised again
+#define DRS_UNDER_BUDGET 0.6f
+// Consecutive frames a condition has to hold before the controller acts on it, dropping is quicker than raising
+#define DRS_DOWN_FRAMES 10
+#define DRS_UP_FRAMES 90
+
+// Dynamic resolution scaling, gives up playfield resolution to hold the target frame rate
+typedef struct {
+    bool enabled;
+    float fraction;
+    // Smoothed, `frame_time` includes waiting for vsync while `work_time` is only the time spent producing a frame
+    float frame_time;
+    float work_time;
+    int over_frames;
+    int under_frames;
+    size_t downscales;
+    size_t upscales;
+} DynamicResolution;
+
+DynamicResolution drs_new();
+// Feeds the last frame's timings, returns true if `fraction` changed
+bool drs_update(DynamicResolution *drs, float frame_time, float work_time);
+
+#endif
@@ -12,13 +12,13 @@ Vector2 transform_center(const TransformComp *transform) {
 }
 
 void physics(PhysicsComp *physics, float dt) {
-    physics->velocity.x /= 1 + (10 * dt);
+    physics->velocity.x /= 1 + (DRAG * dt);
 
     if (!physics->grounded) {
         physics->velocity.y += G * dt;
     }
     /*physics->velocity.x = Clamp(physics->velocity.x, -300, 300);*/
-    physics->velocity.y = Clamp(physics->velocity.y, -800, 800);
+    physics->velocity.y = Clamp(physics->velocity.y, -MAX_FALL_SPEED, MAX_FALL_SPEED);
 }
 
 void physics_add_velocity(PhysicsComp *physics, Vector2 vec) {
@@ -46,56 +46,60 @@ void physics_set_velocity_y(PhysicsComp *physics, float y) {
 }
 
 void collision(TransformComp *transform, PhysicsComp *physics, const Stage *stage, float dt) {
-    float old_x = transform->rect.x;
-    float old_y = transform->rect.y;
+    const float grounded_epsilon = 0.5f;
+    // Landing slower than this doesn't bounce, otherwise resting entities would never settle
+    const float rest_speed = 150.0f;
 
-    float new_x = transform->rect.x + physics->velocity.x * dt;
-    float new_y = transform->rect.y + physics->velocity.y * dt;
+    Rectangle rect = transform->rect;
+    Vector2 delta = Vector2Scale(physics->velocity, dt);
+    const size_t first = physics->contact.side != CS_NONE ? physics->contact.platform : stage->count;
 
-    transform->rect.x = new_x;
-    for (size_t i = 0; i < stage->count; i++) {
-        if (CheckCollisionRecs(transform->rect, stage->platforms[i])) {
-            const Platform *platform = &stage->platforms[i];
-            if (old_x + transform->rect.width <= platform->x) {
-                transform->rect.x = platform->x - transform->rect.width;
-            } else if (old_x >= platform->x + platform->width) {
-                transform->rect.x = platform->x + platform->width;
-            }
-            physics->velocity.x = physics->velocity.x * -0.2;
+    physics->grounded = false;
+    // Slide along whatever we touch, one face per iteration (floor, wall, then nothing left to do)
+    for (int iteration = 0; iteration < 3 && (delta.x != 0 || delta.y != 0); iteration++) {
+        StageHit hit;
+        if (!stage_sweep_rect(stage, rect, delta, first, &hit)) {
+            rect.x += delta.x;
+            rect.y += delta.y;
+            break;
         }
-    }
+        rect.x += delta.x * hit.t;
+        rect.y += delta.y * hit.t;
+        delta = Vector2Scale(delta, 1 - hit.t);
 
-    transform->rect.y = new_y;
-    bool landedOnPlatform = false;
-    const float grounded_epsilon = 0.5f;
-    for (size_t i = 0; i < stage->count; i++) {
-        if (CheckCollisionRecs(transform->rect, stage->platforms[i])) {
-            const Platform *platform = &stage->platforms[i];
-            if (old_y + transform->rect.height <= platform->y + grounded_epsilon && physics->velocity.y >= 0) {
-                transform->rect.y = platform->y - transform->rect.height;
-                physics->velocity.y = physics->velocity.y * -0.2;
-                physics->grounded = true;
-                landedOnPlatform = true;
-            } else if (old_y >= platform->y + platform->height - grounded_epsilon && physics->velocity.y < 0) {
-                transform->rect.y = platform->y + platform->height;
-                physics->velocity.y = physics->velocity.y * -0.2;
-            }
+        ContactSide side;
+        if (hit.normal.x != 0) {
+            delta.x = 0;
+            physics->velocity.x = physics->velocity.x * -0.2;
+            side = hit.normal.x < 0 ? CS_LEFT : CS_RIGHT;
+        } else if (hit.normal.y < 0) {
+            delta.y = 0;
+            physics->velocity.y = physics->velocity.y > rest_speed ? physics->velocity.y * -0.2 : 0;
+            physics->grounded = true;
+            side = CS_TOP;
+        } else {
+            delta.y = 0;
+            physics->velocity.y = physics->velocity.y * -0.2;
+            side = CS_BOTTOM;
         }
-    }
-    if (!landedOnPlatform) {
-        bool nearPlatform = false;
-        for (size_t i = 0; i < stage->count; i++) {
-            const Platform *platform = &stage->platforms[i];
-            if (transform->rect.x + transform->rect.width > platform->x &&
-                transform->rect.x < platform->x + platform->width &&
-                fabs(platform->y - (transform->rect.y + transform->rect.height)) < grounded_epsilon) {
-                nearPlatform = true;
-                break;
-            }
+        // Walls never replace the floor we are standing on, it's what the next sweep wants to try first
+        if (side == CS_TOP || !physics->grounded) {
+            physics->contact = (ContactCache){.platform = hit.platform, .side = side};
         }
-        physics->grounded = nearPlatform;
     }
+    // Resting entities don't move down on their own, a probe that doesn't move them finds the floor they stand on
+    StageHit probe;
+    if (!physics->grounded && physics->velocity.y >= 0 && physics->velocity.y <= rest_speed &&
+        stage_sweep_rect(stage, rect, (Vector2){0, grounded_epsilon}, first, &probe) && probe.normal.y < 0) {
+        physics->velocity.y = 0;
+        physics->grounded = true;
+        physics->contact = (ContactCache){.platform = probe.platform, .side = CS_TOP};
+    }
+    if (!physics->grounded && physics->contact.side == CS_TOP) {
+        physics->contact.side = CS_NONE;
+    }
+    transform->rect = rect;
 }
-void draw_solid(const TransformComp *transform, const SolidRectangleComp *solid_rectangle) {
-    DrawRectangleRec(transform->rect, solid_rectangle->color);
+void draw_solid(const TransformComp *transform, const SolidRectangleComp *solid_rectangle, RectBatch *batch) {
+    rect_batch_push(batch, transform->rect, solid_rectangle->color);
 }
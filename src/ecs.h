@@ -2,6 +2,7 @@
 #define ECS_H
 
 #include <raylib.h>
+#include "render.h"
 #include "stage.h"
 
 // Base Components
@@ -10,9 +11,25 @@ typedef struct {
     Rectangle rect;
 } TransformComp;
 
+// Which side of a platform an entity touched
+typedef enum {
+    CS_NONE = 0,
+    CS_TOP,
+    CS_BOTTOM,
+    CS_LEFT,
+    CS_RIGHT,
+} ContactSide;
+
+// The platform an entity touched last frame, checked first on the next one
+typedef struct {
+    size_t platform;
+    ContactSide side;
+} ContactCache;
+
 typedef struct {
     Vector2 velocity;
     bool grounded;
+    ContactCache contact;
 } PhysicsComp;
 
 typedef struct {
@@ -25,7 +42,7 @@ typedef struct {
 } HealthComp;
 
 #define TRANSFORM(x_, y_, w_, h_) (TransformComp){.rect = {.x = (x_), .y = (y_), .width = (w_), .height = (h_)}}
-#define DEFAULT_PHYSICS() (PhysicsComp){.velocity = {.x = 0, .y = 0}, .grounded = false}
+#define DEFAULT_PHYSICS() (PhysicsComp){.velocity = {.x = 0, .y = 0}, .grounded = false, .contact = {.side = CS_NONE}}
 #define HEALTH(max_, current_) (HealthComp){.max = max_, .current = current_}
 
 Vector2 transform_center(const TransformComp* transform);
@@ -52,12 +69,13 @@ void physics_set_velocity_x(PhysicsComp* physics, float x);
 void physics_set_velocity_y(PhysicsComp* physics, float y);
 
 
-// Does collision for the passed in transform with the current stage
+// Moves the passed in transform by its velocity, sweeping it against the current stage so nothing tunnels through
+// platforms however long the frame was. The platform cached in `physics->contact` is tried first
 void collision(TransformComp* transform, PhysicsComp* physics, 
                     const Stage* stage, float dt); 
 bool offscreen(const TransformComp* transform);
 
 // Draws a solid rectangle at the specified transform with the color in `SolidRectangle`
-void draw_solid(const TransformComp* transform, const SolidRectangleComp* solid_rectangle);
+void draw_solid(const TransformComp* transform, const SolidRectangleComp* solid_rectangle, RectBatch *batch);
 
 #endif
@@ -4,6 +4,7 @@
 #include "particles.h"
 #include "pickup.h"
 #include "raylib.h"
+#include "sounds.h"
 #include "static_config.h"
 #include "timing_utilities.h"
 #include <assert.h>
@@ -78,23 +79,16 @@ ECSEnemy ecs_healing_enemy(Vector2 pos, Vector2 size, size_t speed, size_t healt
                                       .last_hit = 0.0,
                                       .healing = {.heal_amount = heal_amount, .heal_radius = heal_radius}});
 }
-void ranger_bullet_on_hit(Bullet *this, PhysicsComp *victim_physics, HealthComp *victim_health) {
-    victim_health->current -= this->damage;
-    this->active = false;
-    victim_physics->velocity.x += 200 * this->direction.x;
-    victim_physics->velocity.y += 200 * this->direction.y;
-}
-
 #define RANGER_BULLET_SPEED 600
 static Bullet ranger_create_bullet(Vector2 pos, Color c, Vector2 dir) {
     return (Bullet){
         .direction = dir,
-        .creation_time = GetTime(),
+        .creation_time = world_time(),
         .transform = TRANSFORM(pos.x, pos.y, 16, 10),
         .draw_conf = {.color = c},
         .active = true,
         .damage = 1,
-        .on_hit = ranger_bullet_on_hit,
+        .kind = BK_RANGER,
         .speed = RANGER_BULLET_SPEED,
     };
 }
@@ -112,12 +106,12 @@ static void approach_player(const TransformComp *transform, PhysicsComp *physics
 }
 
 static void avoid_player(const TransformComp *transform, PhysicsComp *physics, const EnemyConfigComp *conf,
-                         const TransformComp *player_transform, float prefered_range) {
+                         const TransformComp *player_transform, float prefered_range, Rng *rng) {
     float x_pos_delta = fabs(transform->rect.x + (transform->rect.width / 2.0) -
                              (player_transform->rect.x + (player_transform->rect.width / 2.0)));
 
     const bool player_is_on_the_left = transform->rect.x < player_transform->rect.x;
-    if (x_pos_delta > prefered_range + GetRandomValue(-100, 100)) {
+    if (x_pos_delta > prefered_range + rng_range(rng, -100, 100)) {
         // Move towards the player
         if (player_is_on_the_left) {
             physics->velocity.x += conf->speed;
@@ -137,14 +131,14 @@ static void avoid_player(const TransformComp *transform, PhysicsComp *physics, c
 static void shoot_at(EnemyState *state, const TransformComp *transform, const PhysicsComp *player_physics,
                      const TransformComp *player_transform, Bullets *enemy_bullets,
                      Bullet (*create_bullet)(Vector2, Color, Vector2)) {
-    if (time_delta(state->ranged.last_shot) > state->ranged.reload_time) {
+    if (world_time_since(state->ranged.last_shot) > state->ranged.reload_time) {
         const Vector2 player_center = transform_center(player_transform);
         const float dst = Vector2Distance(player_center, transform_center(transform));
         const double time = (dst / RANGER_BULLET_SPEED) - 1;
         const Vector2 prediction = Vector2Add(player_center, Vector2Scale(player_physics->velocity, time));
         const Vector2 dir = Vector2Normalize(Vector2Subtract(prediction, transform_center(transform)));
         bullets_spawn_bullet(enemy_bullets, create_bullet(transform_center(transform), PINK, dir));
-        state->ranged.last_shot = GetTime();
+        state->ranged.last_shot = world_time();
     }
 }
 
@@ -155,8 +149,8 @@ static void charge(EnemyState *state, const TransformComp *transform, PhysicsCom
     float x_pos_delta = fabs(transform->rect.x + (transform->rect.width / 2.0) -
                              (player_transform->rect.x + (player_transform->rect.width / 2.0)));
     if (x_pos_delta > state->charging.charge_from &&
-        time_delta(state->charging.last_charged) > state->charging.charge_cooldown) {
-        state->charging.last_charged = GetTime();
+        world_time_since(state->charging.last_charged) > state->charging.charge_cooldown) {
+        state->charging.last_charged = world_time();
         if (player_is_on_the_left) {
             physics->velocity.x = state->charging.charge_force;
         } else {
@@ -166,9 +160,10 @@ static void charge(EnemyState *state, const TransformComp *transform, PhysicsCom
     }
 }
 
-static void jump(const TransformComp *player_transform, const TransformComp *transform, PhysicsComp *physics) {
+static void jump(const TransformComp *player_transform, const TransformComp *transform, PhysicsComp *physics,
+                 Rng *rng) {
     if (((player_transform->rect.y + player_transform->rect.height < transform->rect.y) ||
-         GetRandomValue(0, 100) / 100.0 > 0.9) &&
+         rng_range(rng, 0, 100) / 100.0 > 0.9) &&
         physics->grounded) {
         physics->velocity.y = -400;
     }
@@ -176,16 +171,16 @@ static void jump(const TransformComp *player_transform, const TransformComp *tra
 
 void enemy_ai(const EnemyConfigComp *conf, EnemyState *state, const TransformComp *transform, PhysicsComp *physics,
               const TransformComp *player_transform, const PhysicsComp *player_physics, Bullets *enemy_bullets,
-              ECSEnemy *other_enemies, ptrdiff_t other_enemies_len) {
+              ECSEnemy *other_enemies, ptrdiff_t other_enemies_len, Rng *rng) {
     switch (state->type) {
     case ET_BASIC: {
-        jump(player_transform, transform, physics);
+        jump(player_transform, transform, physics, rng);
         approach_player(transform, physics, conf, player_transform);
         break;
     }
     case ET_RANGER: {
-        jump(player_transform, transform, physics);
-        avoid_player(transform, physics, conf, player_transform, 300.0);
+        jump(player_transform, transform, physics, rng);
+        avoid_player(transform, physics, conf, player_transform, 300.0, rng);
         shoot_at(state, transform, player_physics, player_transform, enemy_bullets, ranger_create_bullet);
         break;
     }
@@ -202,61 +197,60 @@ void enemy_ai(const EnemyConfigComp *conf, EnemyState *state, const TransformCom
     }
     case ET_WOLF: {
 
-        jump(player_transform, transform, physics);
+        jump(player_transform, transform, physics, rng);
         approach_player(transform, physics, conf, player_transform);
         charge(state, transform, physics, player_transform);
         break;
     }
     case ET_HEALER: {
-        jump(player_transform, transform, physics);
+        jump(player_transform, transform, physics, rng);
         for (ptrdiff_t i = 0; i < other_enemies_len; i++) {
             if (CheckCollisionCircleRec(transform_center(transform), state->healing.heal_radius,
                                         other_enemies[i].transform.rect)) {
-                other_enemies[i].state.health.current += state->healing.heal_amount * GetFrameTime();
+                other_enemies[i].state.health.current += state->healing.heal_amount * frame_time();
                 other_enemies[i].state.health.current =
                     Clamp(other_enemies[i].state.health.current, 0, other_enemies[i].state.health.max);
             }
         }
-        avoid_player(transform, physics, conf, player_transform, 400.0);
+        avoid_player(transform, physics, conf, player_transform, 400.0, rng);
     }
     case ET_COUNT: {
     }
     }
 }
 void ecs_enemy_update(ECSEnemy *enemy, const Stage *stage, const TransformComp *player_transform,
-                      const PhysicsComp *player_physics, Bullets *bullets, const Sound *hit_sound,
-                      const Sound *death_sound, Bullets *enemy_bullets, Pickups *pickups, Particles *particles,
-                      ECSEnemy *other_enemies, ptrdiff_t other_enemies_len) {
+                      const PhysicsComp *player_physics, Bullets *bullets, Bullets *enemy_bullets, Pickups *pickups,
+                      Particles *particles, ECSEnemy *other_enemies, ptrdiff_t other_enemies_len, Rng *rng) {
     if (enemy->state.dead) {
         return;
     }
     if (enemy->state.health.current <= 0) {
         pickups_spawn(pickups, coin_pickup(enemy->transform.rect.x, enemy->transform.rect.y, 16, 16, 3));
-        if (GetRandomValue(0, 100) < 20) {
+        if (rng_range(rng, 0, 100) < 20) {
             pickups_spawn(pickups, health_pickup(enemy->transform.rect.x, enemy->transform.rect.y, 16, 16, 1));
         }
         particles_spawn_n_in_dir(particles, 10, RED, (Vector2){0, -0.5}, *(Vector2 *)&enemy->transform);
         enemy->state.dead = true;
-        PlaySound(*death_sound);
+        sound_play(SFX_ENEMY_DIE);
         return;
     }
-    const float dt = GetFrameTime();
+    const float dt = frame_time();
 
-    if (time_delta(enemy->state.last_hit) < INVULNERABILITY_TIME) {
+    if (world_time_since(enemy->state.last_hit) < INVULNERABILITY_TIME) {
         enemy->draw_conf.color = RED;
     } else {
         enemy->draw_conf.color = BLUE;
     }
     physics(&enemy->physics, dt);
     enemy_ai(&enemy->enemy_conf, &enemy->state, &enemy->transform, &enemy->physics, player_transform, player_physics,
-             enemy_bullets, other_enemies, other_enemies_len);
+             enemy_bullets, other_enemies, other_enemies_len, rng);
     collision(&enemy->transform, &enemy->physics, stage, dt);
     enemy_bullet_interaction(&enemy->physics, &enemy->state.health, &enemy->transform, bullets, &enemy->state,
-                             hit_sound, particles);
+                             particles);
 }
 
 void enemy_bullet_interaction(PhysicsComp *physics, HealthComp *health, const TransformComp *transform,
-                              Bullets *bullets, EnemyState *state, const Sound *hit_sound, Particles *particles) {
+                              Bullets *bullets, EnemyState *state, Particles *particles) {
     if (state->health.current <= 0) {
         return;
     }
@@ -264,8 +258,8 @@ void enemy_bullet_interaction(PhysicsComp *physics, HealthComp *health, const Tr
         Bullet *bullet = &(*bullets)[i];
         if (bullet->active) {
             if (CheckCollisionRecs(transform->rect, bullet->transform.rect)) {
-                bullet->on_hit(bullet, physics, health);
-                state->last_hit = GetTime();
+                bullet_hit(bullet, physics, health);
+                state->last_hit = world_time();
                 physics->velocity.x += 200 * bullet->direction.x;
                 physics->velocity.y += 200 * bullet->direction.y;
 
@@ -273,18 +267,29 @@ void enemy_bullet_interaction(PhysicsComp *physics, HealthComp *health, const Tr
                 pos.y += transform->rect.height / 2.0;
                 pos.x += transform->rect.width / 2.0;
                 particles_spawn_n_in_dir(particles, 5, RED, Vector2Rotate(bullet->direction, PI), pos);
-                PlaySound(*hit_sound);
+                sound_play(SFX_ENEMY_HIT);
                 return;
             }
         }
     }
 }
 
-void enemy_draw_self(const ECSEnemy *enemy) {
-    draw_solid(&enemy->transform, &enemy->draw_conf);
+Rectangle enemy_draw_bounds(const ECSEnemy *enemy) {
+    const Rectangle rect = enemy->transform.rect;
+    const float top = rect.y - rect.height / 1.5;
+    return (Rectangle){
+        .x = rect.x - rect.width / 2.0,
+        .y = top,
+        .width = rect.width * 2,
+        .height = fmaxf(rect.y + rect.height, top + 16) - top,
+    };
+}
+void enemy_draw_self(const ECSEnemy *enemy, RectBatch *batch) {
+    draw_solid(&enemy->transform, &enemy->draw_conf, batch);
 }
-void enemy_draw_health_bar(const ECSEnemy *enemy) {
-    DrawRectangleRec(
+void enemy_draw_health_bar(const ECSEnemy *enemy, RectBatch *batch) {
+    rect_batch_push(
+        batch,
         (Rectangle){
             .x = enemy->transform.rect.x - enemy->transform.rect.width / 2.0,
             .y = enemy->transform.rect.y - enemy->transform.rect.height / 1.5,
@@ -292,7 +297,8 @@ void enemy_draw_health_bar(const ECSEnemy *enemy) {
             .height = 16,
         },
         GetColor(0x990000ff));
-    DrawRectangleRec(
+    rect_batch_push(
+        batch,
         (Rectangle){
             .x = enemy->transform.rect.x - enemy->transform.rect.width / 2.0,
             .y = enemy->transform.rect.y - enemy->transform.rect.height / 1.5,
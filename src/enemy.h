@@ -5,6 +5,7 @@
 #include "bullet.h"
 #include "particles.h"
 #include "pickup.h"
+#include "rng.h"
 #include <stddef.h>
 #include <stdlib.h>
 
@@ -70,13 +71,16 @@ ECSEnemy ecs_healing_enemy(Vector2 pos, Vector2 size, size_t speed, size_t healt
 
 // Makes the enemy follow the passed in transform `player_transform`
 void enemy_ai(const EnemyConfigComp *conf, EnemyState *state, const TransformComp *transform, PhysicsComp *physics,
-              const TransformComp *player_transform, const PhysicsComp *player_physics, Bullets *enemy_bullets, ECSEnemy* other_enemies, ptrdiff_t other_enemies_len);
+              const TransformComp *player_transform, const PhysicsComp *player_physics, Bullets *enemy_bullets,
+              ECSEnemy *other_enemies, ptrdiff_t other_enemies_len, Rng *rng);
 void ecs_enemy_update(ECSEnemy *enemy, const Stage *stage, const TransformComp *player_transform,
-                      const PhysicsComp *player_physics, Bullets *bullets, const Sound *hit_sound,
-                      const Sound *death_sound, Bullets *enemy_bullets, Pickups *pickups, Particles *particles, ECSEnemy* other_enemies, ptrdiff_t other_enemies_len);
+                      const PhysicsComp *player_physics, Bullets *bullets, Bullets *enemy_bullets, Pickups *pickups,
+                      Particles *particles, ECSEnemy *other_enemies, ptrdiff_t other_enemies_len, Rng *rng);
 // Decrements the enemy health after colliding with a single bullet
 void enemy_bullet_interaction(PhysicsComp *physics, HealthComp *health, const TransformComp *transform,
-                              Bullets *bullets, EnemyState *state, const Sound *hit_sound, Particles *particles);
-void enemy_draw_self(const ECSEnemy* enemy);
-void enemy_draw_health_bar(const ECSEnemy* enemy);
+                              Bullets *bullets, EnemyState *state, Particles *particles);
+// Covers the enemy and its health bar
+Rectangle enemy_draw_bounds(const ECSEnemy* enemy);
+void enemy_draw_self(const ECSEnemy* enemy, RectBatch *batch);
+void enemy_draw_health_bar(const ECSEnemy* enemy, RectBatch *batch);
 #endif
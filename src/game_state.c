@@ -2,16 +2,27 @@
 #include "bullet.h"
 #include "ecs.h"
 #include "enemy.h"
+#include "hash.h"
+#include "indicators.h"
+#include "input.h"
 #include "particles.h"
 #include "pickup.h"
 #include "player.h"
+#include "rng.h"
+#include "save.h"
+#include "schedule.h"
+#include "sim.h"
+#include "sounds.h"
 #include "stage.h"
+#include "static_config.h"
 #include "stb_ds_helper.h"
 #include "timing_utilities.h"
 #include "wave.h"
 #include "weapon.h"
 #include <raylib.h>
 #include <raymath.h>
+#include <rlgl.h>
+#include <stdarg.h>
 #include <stddef.h>
 #include <stdio.h>
 #define STB_DS_IMPLEMENTATION
@@ -19,21 +30,86 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <clay/clay.h>
 #include <clay/clay_raylib_renderer.c>
 
 #define TRANSITION_TIME 0.25
+// The UI keeps being laid out for a bit after the last input, Clay's hover state lags a frame behind and scroll
+// containers keep moving on their own
+#define UI_INPUT_LINGER 0.25
+// Transient strings and scratch arrays of a frame
+#define FRAME_ARENA_SIZE (1024 * 1024)
+// Strings of the retained UI layout
+#define UI_ARENA_SIZE (16 * 1024)
+#define SAVE_FILE_NAME "savefile.bin"
+// A tick level has a handful of systems at most, more workers would only compete with the main thread's
+#define SIM_JOB_WORKERS 3
+// Entities start out with 0 timestamps, the clock starts far enough from that for those to read as long ago
+#define WORLD_CLOCK_START 1000.0
+
+static void game_state_schedule_systems(Schedule *schedule);
 
 void clay_error_callback(Clay_ErrorData errorData) {
     TraceLog(LOG_ERROR, "%s", errorData.errorText.chars);
 }
 
+// Copies what the playfield and the in-game UI are drawn from
+static void world_snapshot_capture(WorldSnapshot *snapshot, const GameState *state) {
+    snapshot->player = state->player;
+    STB_DS_ARRAY_COPY(snapshot->wave, state->current_wave);
+    STB_DS_ARRAY_COPY(snapshot->bullets, state->bullets);
+    STB_DS_ARRAY_COPY(snapshot->enemy_bullets, state->enemy_bullets);
+    STB_DS_ARRAY_COPY(snapshot->pickups, state->pickups);
+    STB_DS_ARRAY_COPY(snapshot->particles.cosmetic, state->particles.cosmetic);
+    snapshot->particles.budget = state->particles.budget;
+    snapshot->particles.rng = state->particles.rng;
+    snapshot->wave_number = state->wave_number;
+    snapshot->wave_strength = state->wave_strength;
+    snapshot->rng = state->rng;
+    snapshot->clock = state->clock;
+    snapshot->schedule_levels = state->tick_schedule.level_count;
+    snapshot->schedule_parallel_runs = state->tick_schedule.parallel_runs;
+    snapshot->request = GP_MAIN;
+    snapshot->consumed_at = 0;
+}
+
+// Puts the world back the way `snapshot` has it, only while the simulation thread doesn't own it
+static void world_snapshot_restore(GameState *state, const WorldSnapshot *snapshot) {
+    state->player = snapshot->player;
+    STB_DS_ARRAY_COPY(state->current_wave, snapshot->wave);
+    STB_DS_ARRAY_COPY(state->bullets, snapshot->bullets);
+    STB_DS_ARRAY_COPY(state->enemy_bullets, snapshot->enemy_bullets);
+    STB_DS_ARRAY_COPY(state->pickups, snapshot->pickups);
+    STB_DS_ARRAY_COPY(state->particles.cosmetic, snapshot->particles.cosmetic);
+    state->particles.budget = snapshot->particles.budget;
+    state->particles.rng = snapshot->particles.rng;
+    state->wave_number = snapshot->wave_number;
+    state->wave_strength = snapshot->wave_strength;
+    state->rng = snapshot->rng;
+    state->clock = snapshot->clock;
+}
+
+// Runs on the simulation thread, which owns the world until it returns false
+static bool game_state_sim_tick(void *user_data, const SimCommand *command, WorldSnapshot *snapshot) {
+    GameState *state = user_data;
+    input_use(&command->input);
+    frame_time_set(command->input.dt);
+    double consumed_at = 0;
+    const GamePhase next = game_state_tick(state, &command->camera, command->view, &consumed_at);
+    world_snapshot_capture(snapshot, state);
+    snapshot->request = next;
+    snapshot->input_sampled_at = command->input.sampled_at;
+    snapshot->consumed_at = consumed_at;
+    return next == GP_MAIN;
+}
+
 GameState game_state_init() {
     GameState st = {0};
     InitWindow(100, 100, "Persona");
     InitAudioDevice();
-    SetWindowState(FLAG_VSYNC_HINT);
+    sounds_load();
     SetWindowSize(GetMonitorWidth(0), GetMonitorHeight(0));
     ToggleFullscreen();
     SetExitKey(0);
@@ -43,24 +119,28 @@ GameState game_state_init() {
 
     Clay_Initialize(st.clay_memory, (Clay_Dimensions){GetMonitorWidth(0), GetMonitorHeight(0)},
                     (Clay_ErrorHandler){.errorHandlerFunction = clay_error_callback});
-    Clay_SetMeasureTextFunction(Raylib_MeasureText, st.font);
 
 #ifndef RELEASE
     Clay_SetDebugModeEnabled(true);
 #endif
-    st.particles = NULL;
-    st.stages = load_stages("assets/stages/index.sti", "assets/stages/stage%zu.st");
+    st.particles = particles_new();
+    st.frame_arena = arena_new(FRAME_ARENA_SIZE);
+    st.ui_arena = arena_new(UI_ARENA_SIZE);
+    st.stages = load_stages(&st.frame_arena, "assets/stages/index.sti", "assets/stages/stage%zu.st");
 
     st.selected_stage = 0;
+    st.rng = rng_new(time(NULL));
+    st.clock = WORLD_CLOCK_START;
     st.player = ecs_player_new();
     st.speed_cost = 1;
     st.phase = GP_TRANSITION;
     st.after_transition = GP_STARTMENU;
     st.font[0] = LoadFontEx("assets/fonts/iosevka medium.ttf", 48, NULL, 255);
     SetTextureFilter(st.font[0].texture, TEXTURE_FILTER_BILINEAR);
+    st.text_atlas = Raylib_TextAtlas_Load();
+    st.text_measure = Raylib_TextMeasureCache_New(st.font, sizeof(st.font) / sizeof(st.font[0]));
+    Clay_SetMeasureTextFunction(Raylib_MeasureText, st.text_measure);
     st.ui_button_click_sound = LoadSound("assets/sfx/button_click.wav");
-    st.enemy_hit_sound = LoadSound("assets/sfx/enemy_hit.wav");
-    st.enemy_die_sound = LoadSound("assets/sfx/enemy_die.wav");
     st.phase_change_sound = LoadSound("assets/sfx/menu_switch.wav");
     st.bullets = NULL;
     st.began_transition = GetTime();
@@ -77,11 +157,23 @@ GameState game_state_init() {
     };
     st.volume_label_opacity = 0.0;
     st.vfx_indicator_opacity = 0.0;
-    st.raw_frame_buffer = LoadRenderTexture(GetMonitorWidth(0), GetMonitorHeight(0));
     st.ui_frame_buffer = LoadRenderTexture(GetMonitorWidth(0), GetMonitorHeight(0));
-    st.final_frame_buffer = LoadRenderTexture(GetMonitorWidth(0), GetMonitorHeight(0));
-    st.pixelizer = LoadShader(NULL, "assets/shaders/pixelizer.fs");
+    st.composite = composite_shader_load();
+    st.render_graph = render_graph_new();
     st.vfx_enabled = true;
+    st.playfield_scale = PLAYFIELD_SCALE;
+    st.drs = drs_new();
+    st.pacing = pacing_new(PACING_LIMIT_VSYNC);
+    game_state_resize_playfield(&st);
+    st.particle_layer = particle_layer_new(GetMonitorWidth(0), GetMonitorHeight(0));
+    st.particle_splat_enabled = true;
+    st.jobs = job_pool_new(JOB_POOL_MAX_THREADS);
+    st.sim_jobs = job_pool_new(SIM_JOB_WORKERS);
+    st.sim = sim_new(game_state_sim_tick);
+    st.tick_schedule = schedule_new();
+    game_state_schedule_systems(&st.tick_schedule);
+    st.batch = rect_batch_new(RECT_BATCH_CAPACITY);
+    st.stage_layer = stage_layer_new();
     st.main_menu_type = MMT_START;
     st.pickups = (Pickups){0};
     st.error = "ERROR";
@@ -89,15 +181,100 @@ GameState game_state_init() {
 
     return st;
 }
+// Hands the world to the simulation thread while a wave is on and picks the snapshot this frame shows. Snapshots
+// trail the input by the tick that's still running
+static void game_state_simulate(GameState *state) {
+    Sim *sim = state->sim;
+    if (!sim->running) {
+        // Also what's shown until the first tick is done
+        world_snapshot_capture(&state->still, state);
+        state->still.input_sampled_at = state->input.sampled_at;
+        state->world = &state->still;
+        latency_begin_frame(&state->latency, state->input.sampled_at);
+        if (state->phase != GP_MAIN) {
+            return;
+        }
+        sim_start(sim, state);
+    }
+
+    sim_tick(sim, &state->input, state->camera, camera_view_rect(&state->camera));
+    bool fresh = false;
+    const WorldSnapshot *latest = sim_latest(sim, &fresh);
+    if (latest == NULL) {
+        // The first tick of the session isn't done yet
+        return;
+    }
+    state->world = latest;
+    latency_begin_frame(&state->latency, latest->input_sampled_at);
+    if (fresh && latest->consumed_at > 0) {
+        latency_consumed(&state->latency, latest->consumed_at);
+    }
+    if (!fresh || latest->request == GP_MAIN) {
+        return;
+    }
+
+    // The wave is over for now, the world is back on this thread
+    sim_stop(sim);
+    const GamePhase next = latest->request;
+    game_state_phase_change(state, next);
+    if (next == GP_AFTER_WAVE) {
+        STB_DS_ARRAY_RESET(state->current_wave);
+
+        state->wave_strength *= 1.2;
+        state->wave_number++;
+        state->current_wave = generate_wave(state->wave_strength, &state->stage, &state->rng);
+    }
+    world_snapshot_capture(&state->still, state);
+    state->still.input_sampled_at = state->input.sampled_at;
+    state->world = &state->still;
+}
+
 void game_state(GameState *state) {
+    if (!pacing_begin_frame(&state->pacing)) {
+        // Nobody is watching, the wave shouldn't go on without the player
+        if (state->sim->running) {
+            sim_stop(state->sim);
+        }
+        if (state->phase == GP_MAIN) {
+            state->phase = GP_PAUSED;
+        } else if (state->phase == GP_TRANSITION && state->after_transition == GP_MAIN) {
+            state->after_transition = GP_PAUSED;
+        }
+        return;
+    }
+    state->frame_started_at = GetTime();
+    arena_reset(&state->frame_arena);
+    state->input = input_capture(state->pacing.input_sampled_at, frame_time());
+    input_use(&state->input);
+    game_state_simulate(state);
     game_state_update(state);
     game_state_frame(state);
 }
 
-void game_state_frame(GameState *state) {
+// Draws the world and the screen space effects on top of it into `raw_frame_buffer`
+static void game_state_render_playfield(GameState *state) {
+    // Particles are aged against the clock of the world they are drawn from
+    world_time_set(state->world->clock);
+    rect_batch_begin(&state->batch, camera_view_rect(&state->camera));
+    if (state->particle_splat_enabled && state->phase != GP_EDITOR) {
+        particles_splat(&state->world->particles, &state->stage, camera_view_rect(&state->camera),
+                        &state->particle_layer, state->jobs, &state->frame_arena);
+    }
+
+    game_state_resize_playfield(state);
+
     BeginTextureMode(state->raw_frame_buffer);
-    BeginMode2D(state->camera);
     ClearBackground(GetColor(0x181818ff));
+    // Confine drawing to the part of the buffer dynamic resolution picked, as if it were the whole buffer
+    const Rectangle viewport = game_state_playfield_viewport(state);
+    rlDrawRenderBatchActive();
+    rlViewport(0, 0, viewport.width, viewport.height);
+    rlMatrixMode(RL_PROJECTION);
+    rlLoadIdentity();
+    rlOrtho(0, viewport.width, viewport.height, 0, 0, 1);
+    rlMatrixMode(RL_MODELVIEW);
+    rlLoadIdentity();
+    BeginMode2D(game_state_playfield_camera(state));
     switch (state->phase) {
     case GP_PAUSED:
     case GP_TRANSITION:
@@ -135,25 +312,28 @@ void game_state_frame(GameState *state) {
 
     EndMode2D();
 
+    // Screen space from here on, in playfield viewport pixels
+    const float w = viewport.width;
+    const float h = viewport.height;
     switch (state->phase) {
     case GP_PAUSED: {
-        DrawRectanglePro((Rectangle){.x = 0, .y = 0, .width = GetMonitorWidth(0), .height = GetMonitorHeight(0)},
+        DrawRectanglePro((Rectangle){.x = 0, .y = 0, .width = w, .height = h},
                          Vector2Zero(), 0, GetColor(0x00000040));
         break;
     }
     case GP_TRANSITION: {
         double t = (GetTime() - state->began_transition) * 1.0 / TRANSITION_TIME;
         if (t < 0.5)
-            DrawRectanglePro((Rectangle){.x = 0, .y = 0, .width = GetMonitorWidth(0), .height = GetMonitorHeight(0)},
+            DrawRectanglePro((Rectangle){.x = 0, .y = 0, .width = w, .height = h},
                              Vector2Zero(), 0, GetColor(0xffffff00 + (t * 255)));
         else
-            DrawRectanglePro((Rectangle){.x = 0, .y = 0, .width = GetMonitorWidth(0), .height = GetMonitorHeight(0)},
+            DrawRectanglePro((Rectangle){.x = 0, .y = 0, .width = w, .height = h},
                              Vector2Zero(), 0, GetColor(0xffffff40 - (t * 255)));
         break;
     }
     case GP_MAIN: {
-        if (state->player.health.current < 5) {
-            DrawRectangle(0, 0, GetMonitorWidth(0), GetMonitorHeight(0),
+        if (state->world->player.health.current < 5) {
+            DrawRectangle(0, 0, w, h,
                           GetColor(0xff000000 + (((sinf(GetTime() * 10) + 1) / 2.0) * 40)));
         }
         break;
@@ -163,42 +343,133 @@ void game_state_frame(GameState *state) {
     }
 
     EndTextureMode();
+}
 
-    if (state->vfx_enabled) {
-        apply_shader(&state->raw_frame_buffer, &state->final_frame_buffer, &state->pixelizer);
-    } else {
-        apply_shader(&state->raw_frame_buffer, &state->final_frame_buffer, NULL);
+// The fused final pass: pixelization, the UI on top and the upscale to the screen in one full screen quad
+static void game_state_composite(GameState *state) {
+    const CompositeShader *composite = &state->composite;
+    const Rectangle viewport = game_state_playfield_viewport(state);
+    const Texture2D playfield = state->raw_frame_buffer.texture;
+
+    // Only a full resolution playfield still needs to be pixelized for its look, 2x2 screen pixels per block
+    Vector2 pixel_size = {0, 0};
+    if (state->raw_frame_scale == 1 && state->vfx_enabled) {
+        pixel_size = (Vector2){
+            2 * viewport.width / GetMonitorWidth(0) / playfield.width,
+            2 * viewport.height / GetMonitorHeight(0) / playfield.height,
+        };
     }
+    const Vector2 screen_size = {GetMonitorWidth(0), GetMonitorHeight(0)};
+    const int playfield_enabled = state->render_graph.passes[RP_PLAYFIELD].live;
+    const int ui_enabled = state->render_graph.passes[RP_UI].live;
+    const Vector4 background = ColorNormalize(GetColor(0x181818ff));
+    SetShaderValue(composite->shader, composite->pixel_size_loc, &pixel_size, SHADER_UNIFORM_VEC2);
+    SetShaderValue(composite->shader, composite->screen_size_loc, &screen_size, SHADER_UNIFORM_VEC2);
+    SetShaderValue(composite->shader, composite->playfield_enabled_loc, &playfield_enabled, SHADER_UNIFORM_INT);
+    SetShaderValue(composite->shader, composite->ui_enabled_loc, &ui_enabled, SHADER_UNIFORM_INT);
+    SetShaderValue(composite->shader, composite->background_loc, &background, SHADER_UNIFORM_VEC4);
+
+    BeginShaderMode(composite->shader);
+    // Binds a texture unit, switching shaders clears those, so only after `BeginShaderMode`
+    SetShaderValueTexture(composite->shader, composite->ui_texture_loc, state->ui_frame_buffer.texture);
+    // Render textures are upside down, what was drawn to the viewport sits at the bottom
+    DrawTexturePro(playfield, (Rectangle){0, 0, viewport.width, -viewport.height},
+                   (Rectangle){0, 0, screen_size.x, screen_size.y}, (Vector2){0, 0}, 0, WHITE);
+    EndShaderMode();
+}
 
-    BeginTextureMode(state->ui_frame_buffer);
-    ClearBackground(GetColor(0));
-    Clay_Raylib_Render(game_state_draw_ui(state), &state->font[0]);
-    EndTextureMode();
+void game_state_frame(GameState *state) {
+    RenderGraph *graph = &state->render_graph;
+    // Nothing of the world is shown on these screens
+    graph->passes[RP_PLAYFIELD].enabled = state->phase != GP_DEAD && state->phase != GP_STARTMENU;
+
+    // Clay is only run again when what the UI shows or the input changed, otherwise last frame's commands are
+    // still good
+    const uint64_t ui_key = game_state_ui_key(state);
+    const Vector2 mouse_delta = GetMouseDelta();
+    const Vector2 wheel = GetMouseWheelMoveV();
+    if (mouse_delta.x != 0 || mouse_delta.y != 0 || wheel.x != 0 || wheel.y != 0 ||
+        IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
+        state->ui_input_at = GetTime();
+    }
+    const bool relayout =
+        !state->ui_layout_valid || ui_key != state->ui_key || GetTime() - state->ui_input_at < UI_INPUT_LINGER;
+    if (relayout) {
+        state->ui_commands = game_state_draw_ui(state);
+        state->ui_key = ui_key;
+        state->ui_layout_valid = true;
+        state->ui_layouts++;
+    }
+    const bool hud_visible = game_state_hud_visible(state);
+    graph->passes[RP_UI].enabled = state->ui_commands.length > 0 || hud_visible;
+    render_graph_cull(graph);
+
+    if (graph->passes[RP_PLAYFIELD].live) {
+        game_state_render_playfield(state);
+    }
+
+    if (!graph->passes[RP_UI].live) {
+        state->ui_buffer_valid = false;
+    } else if (relayout || hud_visible || state->ui_hud_drawn || !state->ui_buffer_valid) {
+        Clay_Raylib_PrepareText(state->text_atlas, state->ui_commands, &state->font[0]);
+        BeginTextureMode(state->ui_frame_buffer);
+        ClearBackground(GetColor(0));
+        game_state_draw_hud(state);
+        Clay_Raylib_Render(state->ui_commands, &state->font[0], state->text_atlas);
+        EndTextureMode();
+        state->ui_buffer_valid = true;
+        state->ui_hud_drawn = hud_visible;
+        state->ui_renders++;
+    }
 
     BeginDrawing();
-    DrawTextureRec(state->final_frame_buffer.texture,
-                   (Rectangle){
-                       0,
-                       (float)state->final_frame_buffer.texture.height,
-                       (float)state->final_frame_buffer.texture.width,
-                       -(float)state->final_frame_buffer.texture.height,
-                   },
-                   (Vector2){0, 0}, WHITE);
-    DrawTextureRec(state->ui_frame_buffer.texture,
-                   (Rectangle){
-                       0,
-                       (float)state->ui_frame_buffer.texture.height,
-                       (float)state->ui_frame_buffer.texture.width,
-                       -(float)state->ui_frame_buffer.texture.height,
-                   },
-                   (Vector2){0, 0}, WHITE);
+    game_state_composite(state);
+    latency_mark(&state->latency, LATENCY_SUBMITTED);
+    // Frames after idling or throttling are long on purpose
+    if (state->pacing.steady && drs_update(&state->drs, frame_time(), GetTime() - state->frame_started_at)) {
+        TraceLog(LOG_DEBUG, "DRS: playfield at %.0f%%", state->drs.fraction * 100);
+    }
     EndDrawing();
+    latency_mark(&state->latency, LATENCY_END_DRAWING);
+    pacing_end_frame(&state->pacing, relayout || game_state_animating(state));
+    latency_end_frame(&state->latency, state->pacing.swapped_at);
+}
+
+void game_state_resize_playfield(GameState *state) {
+    // Turning the vfx off goes back to the smooth full resolution look
+    const int scale = state->vfx_enabled ? Clamp(state->playfield_scale, 1, PLAYFIELD_MAX_SCALE) : 1;
+    if (scale == state->raw_frame_scale) {
+        return;
+    }
+    if (state->raw_frame_scale != 0) {
+        UnloadRenderTexture(state->raw_frame_buffer);
+    }
+    state->raw_frame_scale = scale;
+    state->raw_frame_buffer = LoadRenderTexture(GetMonitorWidth(0) / scale, GetMonitorHeight(0) / scale);
+    SetTextureFilter(state->raw_frame_buffer.texture, TEXTURE_FILTER_POINT);
+}
+
+Rectangle game_state_playfield_viewport(const GameState *state) {
+    return (Rectangle){
+        0,
+        0,
+        (int)(state->raw_frame_buffer.texture.width * state->drs.fraction),
+        (int)(state->raw_frame_buffer.texture.height * state->drs.fraction),
+    };
+}
+
+Camera2D game_state_playfield_camera(const GameState *state) {
+    const float scale = state->drs.fraction / state->raw_frame_scale;
+    Camera2D camera = state->camera;
+    camera.offset = Vector2Scale(camera.offset, scale);
+    camera.zoom *= scale;
+    return camera;
 }
 
 void game_state_update(GameState *state) {
     game_state_update_ui_internals();
 
-    const float dt = GetFrameTime();
+    const float dt = frame_time();
 
     state->volume_label_opacity = Clamp(state->volume_label_opacity / 1.01, 0, 1);
     state->vfx_indicator_opacity = Clamp(state->vfx_indicator_opacity / 1.01, 0, 1);
@@ -219,8 +490,54 @@ void game_state_update(GameState *state) {
         state->vfx_indicator_opacity = 1.0;
     }
 
+    if (IsKeyPressed(KEY_F3)) {
+        state->perf_overlay_enabled = !state->perf_overlay_enabled;
+    }
+
+    if (IsKeyPressed(KEY_F4)) {
+        state->particle_splat_enabled = !state->particle_splat_enabled;
+    }
+
+    // Savestates only make sense while a wave is on
+    const bool in_wave = state->phase == GP_MAIN || state->phase == GP_PAUSED;
+    if (IsKeyPressed(KEY_F5) && in_wave) {
+        // `world` is this frame's snapshot, the simulation thread can keep going
+        const double started = pacing_clock();
+        world_snapshot_copy(&state->savestate, state->world);
+        state->savestate_time = pacing_clock() - started;
+        state->has_savestate = true;
+    }
+
+    if (IsKeyPressed(KEY_F9) && in_wave && state->has_savestate) {
+        if (state->sim->running) {
+            // Started again next frame
+            sim_stop(state->sim);
+        }
+        const double started = pacing_clock();
+        world_snapshot_restore(state, &state->savestate);
+        state->restore_time = pacing_clock() - started;
+        world_snapshot_capture(&state->still, state);
+        state->world = &state->still;
+    }
+
+    if (IsKeyPressed(KEY_F6)) {
+        state->playfield_scale = state->playfield_scale % PLAYFIELD_MAX_SCALE + 1;
+    }
+
+    if (IsKeyPressed(KEY_F7)) {
+        state->drs.enabled = !state->drs.enabled;
+    }
+
+    if (IsKeyPressed(KEY_F8)) {
+        pacing_set_limit(&state->pacing, (state->pacing.limit + 1) % PACING_LIMIT_COUNT);
+    }
+
+    if (IsKeyPressed(KEY_F10)) {
+        state->pacing.late_input = !state->pacing.late_input;
+    }
+
     if (IsKeyPressed(KEY_PRINT_SCREEN)) {
-        TakeScreenshot(TextFormat("pswitch_ss_%.2f.png", GetTime()));
+        TakeScreenshot(arena_printf(&state->frame_arena, "pswitch_ss_%.2f.png", GetTime()));
     }
 
     if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
@@ -229,8 +546,8 @@ void game_state_update(GameState *state) {
 
     switch (state->phase) {
     case GP_MAIN:
-        game_state_update_camera(&state->camera, &state->player.transform);
-        game_state_update_gp_main(state, dt);
+        // The wave itself is ticked on the simulation thread, see `game_state_simulate`
+        game_state_update_camera(&state->camera, &state->world->player.transform);
         break;
     case GP_STARTMENU:
         break;
@@ -254,51 +571,154 @@ void game_state_update(GameState *state) {
 
 void game_state_destroy(GameState *state) {
     UnloadFont(state->font[0]);
+    Raylib_TextAtlas_Unload(state->text_atlas);
+    Raylib_TextMeasureCache_Free(state->text_measure);
     UnloadRenderTexture(state->raw_frame_buffer);
     UnloadRenderTexture(state->ui_frame_buffer);
-    UnloadRenderTexture(state->final_frame_buffer);
-    UnloadShader(state->pixelizer);
+    composite_shader_unload(&state->composite);
+    particle_layer_free(&state->particle_layer);
+    job_pool_free(state->jobs);
+    if (state->sim->running) {
+        sim_stop(state->sim);
+    }
+    sim_free(state->sim);
+    job_pool_free(state->sim_jobs);
+    world_snapshot_free(&state->still);
+    world_snapshot_free(&state->savestate);
+    rect_batch_free(&state->batch);
+    stage_layer_free(&state->stage_layer);
     stbds_arrfree(state->bullets);
     stbds_arrfree(state->enemy_bullets);
     stbds_arrfree(state->current_wave);
     stbds_arrfree(state->pickups);
-    stbds_arrfree(state->particles);
-    save_stages(&state->stages, "assets/stages/index.sti", "assets/stages/stage%zu.st");
+    particles_free(&state->particles);
+    latency_report(&state->latency);
+    save_stages(&state->frame_arena, &state->stages, "assets/stages/index.sti", "assets/stages/stage%zu.st");
     stbds_arrfree(state->stages);
+    arena_free(&state->frame_arena);
+    arena_free(&state->ui_arena);
+    sounds_unload();
     CloseAudioDevice();
     CloseWindow();
 }
 
-void game_state_update_gp_main(GameState *state, float dt) {
-    if (IsKeyPressed(KEY_ESCAPE)) {
-        game_state_phase_change(state, GP_PAUSED);
-        return;
-    }
+// What the systems of a wave tick share, see `game_state_schedule_systems`
+typedef enum {
+    TR_PLAYER,
+    TR_ENEMIES,
+    TR_BULLETS,
+    TR_ENEMY_BULLETS,
+    TR_PICKUPS,
+    TR_PARTICLES,
+    TR_STAGE,
+    TR_RANDOM,  // `GameState.rng`
+    TR_PHASE,   // `TickContext.next`
+    TR_LATENCY, // `TickContext.consumed_at`
+} TickResource;
+
+#define TR(resource) (1u << (resource))
+
+typedef struct {
+    GameState *state;
+    const InputFrame *input;
+    float dt;
+    const Camera2D *camera;
+    Rectangle view;
+    double consumed_at;
+    GamePhase next;
+} TickContext;
+
+// Systems may run on any thread of the job pool, input and the frame time are per thread
+static TickContext *tick_context(void *world) {
+    TickContext *tick = world;
+    input_use(tick->input);
+    frame_time_set(tick->dt);
+    world_time_set(tick->state->clock);
+    return tick;
+}
+
+static void system_particle_budget(void *world) {
+    TickContext *tick = tick_context(world);
+    particles_budget_update(&tick->state->particles, tick->dt, tick->view);
+}
+
+static void system_enemies(void *world) {
+    GameState *state = tick_context(world)->state;
     for (ptrdiff_t i = 0; i < stbds_arrlen(state->current_wave); i++) {
         ecs_enemy_update(&state->current_wave[i], &state->stage, &state->player.transform, &state->player.physics,
-                         &state->bullets, &state->enemy_hit_sound, &state->enemy_die_sound, &state->enemy_bullets,
-                         &state->pickups, &state->particles, state->current_wave, stbds_arrlen(state->current_wave));
-    }
-    ecs_player_update(&state->player, &state->stage, &state->current_wave, &state->bullets, &state->enemy_bullets,
-                      &state->pickups, &state->camera, &state->particles);
-    bullets_update(&state->bullets, dt, &state->stage, &state->particles);
-    bullets_update(&state->enemy_bullets, dt, &state->stage, &state->particles);
-    pickups_update(&state->pickups, &state->stage, dt);
-    if (state->player.state.dead) {
-        game_state_phase_change(state, GP_DEAD);
+                         &state->bullets, &state->enemy_bullets, &state->pickups, &state->particles,
+                         state->current_wave, stbds_arrlen(state->current_wave), &state->rng);
     }
+}
 
-    if (wave_is_done(&state->current_wave)) {
-        if (IsKeyPressed(KEY_ENTER)) {
-            game_state_phase_change(state, GP_AFTER_WAVE);
-            STB_DS_ARRAY_RESET(state->current_wave);
+static void system_player(void *world) {
+    TickContext *tick = tick_context(world);
+    GameState *state = tick->state;
+    if (ecs_player_update(&state->player, &state->stage, &state->current_wave, &state->bullets,
+                          &state->enemy_bullets, &state->pickups, tick->camera, &state->particles, &state->rng)) {
+        tick->consumed_at = pacing_clock();
+    }
+}
 
-            state->wave_strength *= 1.2;
-            state->wave_number++;
-            state->current_wave = generate_wave(state->wave_strength, &state->stage);
-        }
+static void system_bullets(void *world) {
+    TickContext *tick = tick_context(world);
+    bullets_update(&tick->state->bullets, tick->dt, &tick->state->stage, &tick->state->particles);
+}
+
+static void system_enemy_bullets(void *world) {
+    TickContext *tick = tick_context(world);
+    bullets_update(&tick->state->enemy_bullets, tick->dt, &tick->state->stage, &tick->state->particles);
+}
+
+static void system_pickups(void *world) {
+    TickContext *tick = tick_context(world);
+    pickups_update(&tick->state->pickups, &tick->state->stage, tick->dt);
+}
+
+static void system_wave_progress(void *world) {
+    TickContext *tick = tick_context(world);
+    GameState *state = tick->state;
+    if (state->player.state.dead) {
+        tick->next = GP_DEAD;
+    }
+    // The next wave is generated on the main thread once the world is handed back
+    if (wave_is_done(&state->current_wave) && input_key_pressed(KEY_ENTER)) {
+        tick->next = GP_AFTER_WAVE;
     }
-    particles_update(&state->particles, &state->stage, dt);
+}
+
+// Systems conflicting with each other run in the order they are added in here, the rest side by side
+static void game_state_schedule_systems(Schedule *schedule) {
+    schedule_add(schedule, "particle budget", system_particle_budget, 0, TR(TR_PARTICLES));
+    schedule_add(schedule, "enemies", system_enemies, TR(TR_PLAYER) | TR(TR_STAGE),
+                 TR(TR_ENEMIES) | TR(TR_BULLETS) | TR(TR_ENEMY_BULLETS) | TR(TR_PICKUPS) | TR(TR_PARTICLES) |
+                     TR(TR_RANDOM));
+    schedule_add(schedule, "player", system_player, TR(TR_ENEMIES) | TR(TR_STAGE),
+                 TR(TR_PLAYER) | TR(TR_BULLETS) | TR(TR_ENEMY_BULLETS) | TR(TR_PICKUPS) | TR(TR_PARTICLES) |
+                     TR(TR_RANDOM) | TR(TR_LATENCY));
+    schedule_add(schedule, "bullets", system_bullets, TR(TR_STAGE), TR(TR_BULLETS) | TR(TR_PARTICLES));
+    schedule_add(schedule, "enemy bullets", system_enemy_bullets, TR(TR_STAGE),
+                 TR(TR_ENEMY_BULLETS) | TR(TR_PARTICLES));
+    schedule_add(schedule, "pickups", system_pickups, TR(TR_STAGE), TR(TR_PICKUPS));
+    schedule_add(schedule, "wave progress", system_wave_progress, TR(TR_PLAYER) | TR(TR_ENEMIES), TR(TR_PHASE));
+}
+
+GamePhase game_state_tick(GameState *state, const Camera2D *camera, Rectangle view, double *consumed_at) {
+    if (input_key_pressed(KEY_ESCAPE)) {
+        return GP_PAUSED;
+    }
+    TickContext tick = {
+        .state = state,
+        .input = input_current(),
+        .dt = frame_time(),
+        .camera = camera,
+        .view = view,
+        .next = GP_MAIN,
+    };
+    state->clock += tick.dt;
+    schedule_run(&state->tick_schedule, state->sim_jobs, &tick);
+    *consumed_at = tick.consumed_at;
+    return tick.next;
 }
 
 void game_state_update_gp_dead(GameState *state, float dt) {
@@ -308,7 +728,7 @@ void game_state_update_gp_dead(GameState *state, float dt) {
         state->began_transition = GetTime();
         state->player = ecs_player_new();
         state->stage = state->stages[state->selected_stage];
-        state->current_wave = generate_wave(state->wave_strength, &state->stage);
+        state->current_wave = generate_wave(state->wave_strength, &state->stage, &state->rng);
         state->player.transform.rect.x = state->stage.spawn.x;
         state->player.transform.rect.y = state->stage.spawn.y;
     }
@@ -433,7 +853,7 @@ void game_state_update_editor(GameState *state, float dt) {
     }
     if (state->editor_state.selected == 0xffff || state->editor_state.selected == SPAWN_SELECT)
         return;
-    float moveStep = 5.0f * GetFrameTime();
+    float moveStep = 5.0f * frame_time();
     Rectangle *obj = NULL;
     if (state->editor_state.selected < state->editor_state.s.count) {
         obj = &state->editor_state.s.platforms[state->editor_state.selected];
@@ -473,11 +893,11 @@ void game_state_update_ui_internals() {
     Vector2 mousePosition = GetMousePosition();
     Vector2 scrollDelta = GetMouseWheelMoveV();
     Clay_SetPointerState((Clay_Vector2){mousePosition.x, mousePosition.y}, IsMouseButtonDown(0));
-    Clay_UpdateScrollContainers(true, (Clay_Vector2){scrollDelta.x, scrollDelta.y}, GetFrameTime());
+    Clay_UpdateScrollContainers(true, (Clay_Vector2){scrollDelta.x, scrollDelta.y}, frame_time());
 }
 
 void game_state_update_camera(Camera2D *camera, const TransformComp *target) {
-    const float smoothing_factor = 2.0f * GetFrameTime();
+    const float smoothing_factor = 2.0f * frame_time();
     const Vector2 mouse_position = GetMousePosition();
 
     Vector2 desired_camera_target = (Vector2){target->rect.x, target->rect.y};
@@ -490,55 +910,49 @@ void game_state_update_camera(Camera2D *camera, const TransformComp *target) {
     camera->target.y = Lerp(camera->target.y, desired_camera_target.y, smoothing_factor);
 }
 
-void game_state_draw_playfield(const GameState *state) {
-    draw_stage(&state->stage);
-    wave_draw(&state->current_wave);
-    bullets_draw(&state->bullets);
-    bullets_draw(&state->enemy_bullets);
-    player_draw(&state->player);
-    pickups_draw(&state->pickups);
-    particles_draw(&state->particles);
+Rectangle camera_view_rect(const Camera2D *camera) {
+    const Vector2 top_left = GetScreenToWorld2D(Vector2Zero(), *camera);
+    return (Rectangle){
+        .x = top_left.x,
+        .y = top_left.y,
+        .width = GetMonitorWidth(0) / camera->zoom,
+        .height = GetMonitorHeight(0) / camera->zoom,
+    };
+}
+
+void game_state_draw_playfield(GameState *state) {
+    const WorldSnapshot *world = state->world;
+    world_time_set(world->clock);
+    stage_layer_draw(&state->stage_layer, &state->stage);
+    wave_draw(&world->wave, &state->batch);
+    bullets_draw(&world->bullets, &state->batch);
+    bullets_draw(&world->enemy_bullets, &state->batch);
+    player_draw(&world->player, &state->batch);
+    pickups_draw(&world->pickups, &state->batch);
+    if (state->particle_splat_enabled) {
+        rect_batch_flush(&state->batch);
+        particle_layer_draw(&state->particle_layer);
+    } else {
+        particles_draw(&world->particles, &state->stage, &state->batch);
+    }
 
-    const float arrow_length = 50.0f;
-    const float arrow_thickness = 5.0f;
-    Color arrow_color = GetColor(0xff000055);
-    for (ptrdiff_t i = 0; i < stbds_arrlen(state->current_wave); i++) {
-        if (state->current_wave[i].state.dead) {
-            continue;
+    const Vector2 player_center = {world->player.transform.rect.x + world->player.transform.rect.width / 2,
+                                   world->player.transform.rect.y + world->player.transform.rect.height / 2};
+    Indicators enemies = indicators_new(player_center, state->batch.view);
+    for (ptrdiff_t i = 0; i < stbds_arrlen(world->wave); i++) {
+        if (!world->wave[i].state.dead) {
+            indicators_add(&enemies, world->wave[i].transform.rect);
         }
-        Vector2 direction =
-            Vector2Normalize((Vector2){state->current_wave[i].transform.rect.x -
-                                           (state->player.transform.rect.x + state->player.transform.rect.width / 2),
-                                       state->current_wave[i].transform.rect.y -
-                                           (state->player.transform.rect.y + state->player.transform.rect.height / 2)});
-
-        Vector2 arrow_end = {
-            (state->player.transform.rect.x + state->player.transform.rect.width / 2) + direction.x * arrow_length,
-            (state->player.transform.rect.y + state->player.transform.rect.height / 2) + direction.y * arrow_length};
-
-        DrawLineEx((Vector2){state->player.transform.rect.x + state->player.transform.rect.width / 2,
-                             state->player.transform.rect.y + state->player.transform.rect.height / 2},
-                   arrow_end, arrow_thickness, arrow_color);
-    }
-    arrow_color = GetColor(0x00ff0055);
-    for (ptrdiff_t i = 0; i < stbds_arrlen(state->pickups); i++) {
-        if (!state->pickups[i].active) {
-            continue;
+    }
+    indicators_draw(&enemies, GetColor(0xff000055), &state->batch);
+    Indicators pickups = indicators_new(player_center, state->batch.view);
+    for (ptrdiff_t i = 0; i < stbds_arrlen(world->pickups); i++) {
+        if (world->pickups[i].active) {
+            indicators_add(&pickups, world->pickups[i].transform.rect);
         }
-        Vector2 direction =
-            Vector2Normalize((Vector2){state->pickups[i].transform.rect.x -
-                                           (state->player.transform.rect.x + state->player.transform.rect.width / 2),
-                                       state->pickups[i].transform.rect.y -
-                                           (state->player.transform.rect.y + state->player.transform.rect.height / 2)});
-
-        Vector2 arrow_end = {
-            (state->player.transform.rect.x + state->player.transform.rect.width / 2) + direction.x * arrow_length,
-            (state->player.transform.rect.y + state->player.transform.rect.height / 2) + direction.y * arrow_length};
-
-        DrawLineEx((Vector2){state->player.transform.rect.x + state->player.transform.rect.width / 2,
-                             state->player.transform.rect.y + state->player.transform.rect.height / 2},
-                   arrow_end, arrow_thickness, arrow_color);
     }
+    indicators_draw(&pickups, GetColor(0x00ff0055), &state->batch);
+    rect_batch_flush(&state->batch);
 }
 
 void ui_label(const char *text, uint16_t size, Color c, Clay_TextAlignment aligment) {
@@ -594,7 +1008,7 @@ void handle_start_game_button(Clay_ElementId e_id, Clay_PointerData pd, intptr_t
         game_state_start_new_wave(state);
         state->wave_strength *= 1.1;
         state->wave_number++;
-        state->current_wave = generate_wave(state->wave_strength, &state->stage);
+        state->current_wave = generate_wave(state->wave_strength, &state->stage, &state->rng);
         state->player.transform.rect.x = state->stage.spawn.x;
         state->player.transform.rect.y = state->stage.spawn.y;
     }
@@ -608,58 +1022,71 @@ void handle_editor_start_button(Clay_ElementId e_id, Clay_PointerData pd, intptr
     }
 }
 
+// Only shown while paused, the simulation thread doesn't own the world then
 void handle_save_button(Clay_ElementId e_id, Clay_PointerData pd, intptr_t ud) {
     (void)e_id;
     GameState *state = (GameState *)ud;
-    (void)state;
     if (pd.state == CLAY_POINTER_DATA_PRESSED_THIS_FRAME) {
-        const size_t size =
-            sizeof(ECSPlayer) + sizeof(Pickups) + sizeof(EnemyWave) + sizeof(double) + sizeof(size_t) + sizeof(size_t);
-        uint8_t *data = calloc(size, 1);
-        size_t cursor = 0;
-        memcpy(data, &state->player, sizeof(ECSPlayer));
-        cursor += sizeof(ECSPlayer);
-        memcpy(data + cursor, &state->pickups, sizeof(Pickups));
-        cursor += sizeof(Pickups);
-        memcpy(data + cursor, &state->current_wave, sizeof(EnemyWave));
-        cursor += sizeof(EnemyWave);
-        memcpy(data + cursor, &state->wave_strength, sizeof(double));
-        cursor += sizeof(double);
-        memcpy(data + cursor, &state->wave_number, sizeof(size_t));
-        cursor += sizeof(size_t);
-        memcpy(data + cursor, &state->selected_stage, sizeof(size_t));
-        cursor += sizeof(size_t);
-        SaveFileData("savefile.bin", data, size);
-        free(data);
+        const SaveGame game = {
+            .progress =
+                {
+                    .wave_number = state->wave_number,
+                    .wave_strength = state->wave_strength,
+                    .selected_stage = state->selected_stage,
+                    .speed_cost = state->speed_cost,
+                    .rng = state->rng,
+                    .clock = state->clock,
+                },
+            .player = state->player,
+            .wave = state->current_wave,
+            .wave_count = stbds_arrlen(state->current_wave),
+            .bullets = state->bullets,
+            .bullet_count = stbds_arrlen(state->bullets),
+            .enemy_bullets = state->enemy_bullets,
+            .enemy_bullet_count = stbds_arrlen(state->enemy_bullets),
+            .pickups = state->pickups,
+            .pickup_count = stbds_arrlen(state->pickups),
+        };
+        const SaveResult result = save_write(SAVE_FILE_NAME, &game);
+        if (result != SAVE_OK) {
+            flash_error(state, save_result_message(result));
+        }
     }
 }
 
 void handle_continue_game_button(Clay_ElementId e_id, Clay_PointerData pd, intptr_t ud) {
     (void)e_id;
     GameState *state = (GameState *)ud;
-    (void)state;
     if (pd.state == CLAY_POINTER_DATA_PRESSED_THIS_FRAME) {
-        int got_size = 0;
-        if (FileExists("savefile.bin")) {
-            uint8_t *data = LoadFileData("savefile.bin", &got_size);
-            uint8_t *data_unmoved = data;
-            memcpy(&state->player, data, sizeof(ECSPlayer));
-            data += sizeof(ECSPlayer);
-            memcpy(&state->pickups, data, sizeof(Pickups));
-            data += sizeof(Pickups);
-            memcpy(&state->current_wave, data, sizeof(EnemyWave));
-            data += sizeof(EnemyWave);
-            memcpy(&state->wave_strength, data, sizeof(double));
-            data += sizeof(double);
-            memcpy(&state->wave_number, data, sizeof(size_t));
-            data += sizeof(size_t);
-            memcpy(&state->selected_stage, data, sizeof(size_t));
-            data += sizeof(size_t);
-            game_state_phase_change(state, GP_MAIN);
-            MemFree(data_unmoved);
-        } else {
+        if (!FileExists(SAVE_FILE_NAME)) {
             flash_error(state, "Save file not found");
+            return;
+        }
+        SaveGame game;
+        const SaveResult result = save_read(SAVE_FILE_NAME, &game);
+        if (result != SAVE_OK) {
+            flash_error(state, save_result_message(result));
+            return;
         }
+        if (game.progress.selected_stage >= (uint64_t)stbds_arrlen(state->stages)) {
+            flash_error(state, "Save file is for a stage that doesn't exist");
+            save_game_free(&game);
+            return;
+        }
+        state->wave_number = game.progress.wave_number;
+        state->wave_strength = game.progress.wave_strength;
+        state->selected_stage = game.progress.selected_stage;
+        state->speed_cost = game.progress.speed_cost;
+        state->rng = game.progress.rng;
+        // The timestamps of the loaded entities are on the clock they were saved with
+        state->clock = game.progress.clock;
+        state->player = game.player;
+        STB_DS_ARRAY_ASSIGN(state->current_wave, game.wave, game.wave_count);
+        STB_DS_ARRAY_ASSIGN(state->bullets, game.bullets, game.bullet_count);
+        STB_DS_ARRAY_ASSIGN(state->enemy_bullets, game.enemy_bullets, game.enemy_bullet_count);
+        STB_DS_ARRAY_ASSIGN(state->pickups, game.pickups, game.pickup_count);
+        save_game_free(&game);
+        game_state_phase_change(state, GP_MAIN);
     }
 }
 
@@ -787,6 +1214,7 @@ void handle_save_stage_editor(Clay_ElementId e_id, Clay_PointerData pd, intptr_t
     (void)e_id;
     GameState *state = (GameState *)ud;
     if (pd.state == CLAY_POINTER_DATA_PRESSED_THIS_FRAME) {
+        stage_bake(&state->editor_state.s);
         stbds_arrput(state->stages, state->editor_state.s);
     }
 }
@@ -918,9 +1346,30 @@ void button(Clay_ElementId id, Clay_SizingAxis x_sizing, Clay_SizingAxis y_sizin
     }
 }
 
-Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
-    DrawTextEx(state->font[0], TextFormat("Volume: %.2f", GetMasterVolume() * 100), (Vector2){500, 40}, 48, 0,
-               GetColor(0xffffff00 + (state->volume_label_opacity * 255)));
+bool game_state_hud_visible(const GameState *state) {
+    // The flashes are drawn with `opacity * 255` as their alpha, anything under 1 is invisible
+    const double visible = 1.0 / 255;
+    return state->perf_overlay_enabled || state->volume_label_opacity >= visible ||
+           state->vfx_indicator_opacity >= visible || state->error_opacity >= visible;
+}
+
+bool game_state_animating(const GameState *state) {
+    switch (state->phase) {
+    case GP_MAIN:
+    case GP_TRANSITION:
+    case GP_EDITOR:
+        return true;
+    default:
+        break;
+    }
+    // Cosmetic particles of the last wave still fade out behind the menus for a while
+    return time_delta(state->began_transition) < TRANSITION_TIME + PARTICLE_LIFETIME ||
+           GetTime() - state->ui_input_at < UI_INPUT_LINGER || game_state_hud_visible(state);
+}
+
+void game_state_draw_hud(GameState *state) {
+    DrawTextEx(state->font[0], arena_printf(&state->frame_arena, "Volume: %.2f", GetMasterVolume() * 100),
+               (Vector2){500, 40}, 48, 0, GetColor(0xffffff00 + (state->volume_label_opacity * 255)));
     if (state->vfx_enabled) {
         DrawTextEx(state->font[0], "VFX enabled", (Vector2){500, 40}, 48, 0,
                    GetColor(0xffffff00 + (state->vfx_indicator_opacity * 255)));
@@ -931,12 +1380,60 @@ Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
 
     DrawTextEx(state->font[0], state->error, (Vector2){200, 200}, 60, 0,
                GetColor(0xff000000 + (state->error_opacity * 255)));
+    if (state->perf_overlay_enabled) {
+        game_state_draw_perf_overlay(state);
+    }
+}
+
+uint64_t game_state_ui_key(const GameState *state) {
+    uint64_t key = fnv1a(FNV1A_OFFSET, &state->phase, sizeof(state->phase));
+#define UI_DEPENDS_ON(value)                                                                                           \
+    do {                                                                                                               \
+        const __typeof__(value) v_ = (value);                                                                          \
+        key = fnv1a(key, &v_, sizeof(v_));                                                                             \
+    } while (0)
+    switch (state->phase) {
+    case GP_MAIN:
+        UI_DEPENDS_ON(wave_is_done(&state->world->wave));
+        UI_DEPENDS_ON(state->world->player.health.current);
+        UI_DEPENDS_ON(state->world->player.health.max);
+        UI_DEPENDS_ON(state->world->player.selected);
+        UI_DEPENDS_ON(state->world->wave_number);
+        UI_DEPENDS_ON(state->world->player.state.coins);
+        break;
+    case GP_STARTMENU:
+        UI_DEPENDS_ON(state->main_menu_type);
+        UI_DEPENDS_ON(stbds_arrlen(state->stages));
+        break;
+    case GP_AFTER_WAVE:
+        UI_DEPENDS_ON(state->screen_type);
+        UI_DEPENDS_ON(state->player.state.jump_power);
+        for (size_t i = 0; i < sizeof(state->player.weapons) / sizeof(state->player.weapons[0]); i++) {
+            UI_DEPENDS_ON(state->player.weapons[i].fire_rate);
+            UI_DEPENDS_ON(state->player.weapons[i].fire_rate_upgrade_cost);
+            UI_DEPENDS_ON(state->player.weapons[i].damage);
+            UI_DEPENDS_ON(state->player.weapons[i].damage_upgrade_cost);
+        }
+        break;
+    case GP_DEAD:
+    case GP_EDITOR:
+    case GP_PAUSED:
+    case GP_TRANSITION:
+        break;
+    }
+#undef UI_DEPENDS_ON
+    return key;
+}
+
+Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
+    // Strings handed to Clay are only pointed to, they have to live for as long as the layout is reused
+    arena_reset(&state->ui_arena);
     Clay_BeginLayout();
     ui_container(CLAY_ID("OuterContainer"), CLAY_TOP_TO_BOTTOM, CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0), 0, 16) {
 
         switch (state->phase) {
         case GP_MAIN: {
-            if (wave_is_done(&state->current_wave)) {
+            if (wave_is_done(&state->world->wave)) {
                 CENTERED_ELEMENT(
                     ui_label("Press enter to enter the intermission screen", 36, WHITE, CLAY_TEXT_ALIGN_CENTER));
             }
@@ -956,7 +1453,8 @@ Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
                     CLAY({.backgroundColor = {255, 0, 0, 255},
                           .cornerRadius = {16, 16, 16, 16},
                           .layout = {
-                              .sizing = {CLAY_SIZING_PERCENT(state->player.health.current / state->player.health.max),
+                              .sizing = {CLAY_SIZING_PERCENT(state->world->player.health.current /
+                                                             state->world->player.health.max),
                                          CLAY_SIZING_GROW(0)}}});
                 }
                 CLAY({.backgroundColor = {100, 100, 100, 255},
@@ -969,11 +1467,11 @@ Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
                                  .childGap = 16,
                                  .padding = {16, 16, 16, 16}}}) {
                     LABELED_BUTTON(CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0), "Pistol", "PistolLabel", NULL,
-                                   state->player.selected == WT_PISTOL);
+                                   state->world->player.selected == WT_PISTOL);
                     LABELED_BUTTON(CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0), "AR", "ARLabel", NULL,
-                                   state->player.selected == WT_AR);
+                                   state->world->player.selected == WT_AR);
                     LABELED_BUTTON(CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0), "Shotgun", "ShotgunLabel", NULL,
-                                   state->player.selected == WT_SHOTGUN);
+                                   state->world->player.selected == WT_SHOTGUN);
                 }
                 CLAY({.backgroundColor = {100, 100, 100, 255},
                       .cornerRadius = {16, 16, 16, 16},
@@ -985,8 +1483,10 @@ Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
                                  .childGap = 16,
                                  .padding = {16, 16, 16, 16},
                                  .layoutDirection = CLAY_TOP_TO_BOTTOM}}) {
-                    ui_label(TextFormat("Wave #%d", state->wave_number - 1), 36, WHITE, CLAY_TEXT_ALIGN_CENTER);
-                    ui_label(TextFormat("Cash: %.2f", state->player.state.coins), 36, WHITE, CLAY_TEXT_ALIGN_CENTER);
+                    ui_label(arena_printf(&state->ui_arena, "Wave #%zu", state->world->wave_number - 1), 36, WHITE,
+                             CLAY_TEXT_ALIGN_CENTER);
+                    ui_label(arena_printf(&state->ui_arena, "Cash: %.2f", state->world->player.state.coins), 36, WHITE,
+                             CLAY_TEXT_ALIGN_CENTER);
                 }
             }
             break;
@@ -1029,6 +1529,15 @@ Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
                         ui_label("Right bracket: Increase master volume by 5%", 36, WHITE, CLAY_TEXT_ALIGN_LEFT);
                         ui_label("Slash: Toggle shaders OwO", 36, WHITE, CLAY_TEXT_ALIGN_LEFT);
                         ui_label("Print screen: Take screenshot", 36, WHITE, CLAY_TEXT_ALIGN_LEFT);
+                        ui_label("F3: Toggle performance overlay", 36, WHITE, CLAY_TEXT_ALIGN_LEFT);
+                        ui_label("F4: Toggle CPU particle splatting", 36, WHITE, CLAY_TEXT_ALIGN_LEFT);
+                        ui_label("F5: Save state of the wave", 36, WHITE, CLAY_TEXT_ALIGN_LEFT);
+                        ui_label("F6: Cycle playfield resolution", 36, WHITE, CLAY_TEXT_ALIGN_LEFT);
+                        ui_label("F7: Toggle dynamic resolution", 36, WHITE, CLAY_TEXT_ALIGN_LEFT);
+                        ui_label("F8: Cycle frame limit (vsync, target, uncapped)", 36, WHITE,
+                                 CLAY_TEXT_ALIGN_LEFT);
+                        ui_label("F9: Load saved state", 36, WHITE, CLAY_TEXT_ALIGN_LEFT);
+                        ui_label("F10: Toggle late input sampling", 36, WHITE, CLAY_TEXT_ALIGN_LEFT);
                     }
                     break;
                 }
@@ -1045,7 +1554,7 @@ Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
                               .scroll = {.vertical = true}}) {
                             for (ptrdiff_t i = 0; i < stbds_arrlen(state->stages); i++) {
                                 const ThatOneSpecificInput input = (ThatOneSpecificInput){state, i};
-                                const char *cstr = TextFormat("Stage #%zu", i + 1);
+                                const char *cstr = arena_printf(&state->ui_arena, "Stage #%zu", i + 1);
                                 const Clay_String str = {.chars = cstr, .length = strlen(cstr)};
                                 button(CLAY_IDI("StageButton", i), CLAY_SIZING_GROW(0), CLAY_SIZING_PERCENT(0.1), str,
                                        (Clay_Color){50, 50, 50, 255}, (Clay_Color){255, 255, 255, 255},
@@ -1145,14 +1654,14 @@ Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
                               .cornerRadius = {16, 16, 16, 16}}) {
                             ui_label("Pistol", 48, WHITE, CLAY_TEXT_ALIGN_CENTER);
                             LABELED_BUTTON(CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0),
-                                           TextFormat("Firerate: %.2f / sec. [Cost: %.2f]",
-                                                      state->player.weapons[WT_PISTOL].fire_rate / 1.0,
-                                                      state->player.weapons[WT_PISTOL].fire_rate_upgrade_cost),
+                                           arena_printf(&state->ui_arena, "Firerate: %.2f / sec. [Cost: %.2f]",
+                                                        state->player.weapons[WT_PISTOL].fire_rate / 1.0,
+                                                        state->player.weapons[WT_PISTOL].fire_rate_upgrade_cost),
                                            "PistolFireRateUpgradeButton", handle_pistol_fire_rate_upgrade, false);
                             LABELED_BUTTON(CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0),
-                                           TextFormat("Damage: %d [Cost: %.2f]",
-                                                      state->player.weapons[WT_PISTOL].damage,
-                                                      state->player.weapons[WT_PISTOL].damage_upgrade_cost),
+                                           arena_printf(&state->ui_arena, "Damage: %d [Cost: %.2f]",
+                                                        state->player.weapons[WT_PISTOL].damage,
+                                                        state->player.weapons[WT_PISTOL].damage_upgrade_cost),
                                            "PistolDamageUpgradeButton", handle_pistol_damage_upgrade, false);
                         }
                         CLAY({.id = CLAY_ID("ARUpgrades"),
@@ -1164,13 +1673,14 @@ Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
                               .cornerRadius = {16, 16, 16, 16}}) {
                             ui_label("AR", 48, WHITE, CLAY_TEXT_ALIGN_CENTER);
                             LABELED_BUTTON(CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0),
-                                           TextFormat("Firerate: %.2f / sec. [Cost: %.2f]",
-                                                      state->player.weapons[WT_AR].fire_rate / 1.0,
-                                                      state->player.weapons[WT_AR].fire_rate_upgrade_cost),
+                                           arena_printf(&state->ui_arena, "Firerate: %.2f / sec. [Cost: %.2f]",
+                                                        state->player.weapons[WT_AR].fire_rate / 1.0,
+                                                        state->player.weapons[WT_AR].fire_rate_upgrade_cost),
                                            "ARFireRateUpgradeButton", handle_ar_fire_rate_upgrade, false);
                             LABELED_BUTTON(CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0),
-                                           TextFormat("Damage: %d [Cost: %.2f]", state->player.weapons[WT_AR].damage,
-                                                      state->player.weapons[WT_AR].damage_upgrade_cost),
+                                           arena_printf(&state->ui_arena, "Damage: %d [Cost: %.2f]",
+                                                        state->player.weapons[WT_AR].damage,
+                                                        state->player.weapons[WT_AR].damage_upgrade_cost),
                                            "ARDamageUpgradeButton", handle_ar_damage_upgrade, false);
                         }
                         CLAY({.id = CLAY_ID("ShotgunUpgrades"),
@@ -1182,14 +1692,14 @@ Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
                               .cornerRadius = {16, 16, 16, 16}}) {
                             ui_label("Shotgun", 48, WHITE, CLAY_TEXT_ALIGN_CENTER);
                             LABELED_BUTTON(CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0),
-                                           TextFormat("Firerate: %.2f / sec. [Cost: %.2f]",
-                                                      state->player.weapons[WT_SHOTGUN].fire_rate / 1.0,
-                                                      state->player.weapons[WT_SHOTGUN].fire_rate_upgrade_cost),
+                                           arena_printf(&state->ui_arena, "Firerate: %.2f / sec. [Cost: %.2f]",
+                                                        state->player.weapons[WT_SHOTGUN].fire_rate / 1.0,
+                                                        state->player.weapons[WT_SHOTGUN].fire_rate_upgrade_cost),
                                            "ShotgunFireRateUpgradeButton", handle_shotgun_fire_rate_upgrade, false);
                             LABELED_BUTTON(CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0),
-                                           TextFormat("Damage: %d [Cost: %.2f]",
-                                                      state->player.weapons[WT_SHOTGUN].damage,
-                                                      state->player.weapons[WT_SHOTGUN].damage_upgrade_cost),
+                                           arena_printf(&state->ui_arena, "Damage: %d [Cost: %.2f]",
+                                                        state->player.weapons[WT_SHOTGUN].damage,
+                                                        state->player.weapons[WT_SHOTGUN].damage_upgrade_cost),
                                            "ShotgunDamageUpgradeButton", handle_shotgun_damage_upgrade, false);
                         }
                     }
@@ -1219,14 +1729,89 @@ Clay_RenderCommandArray game_state_draw_ui(GameState *state) {
     return Clay_EndLayout();
 }
 
-Stage *load_stages(const char *index_file_name, const char *stage_file_name_format) {
+static void perf_overlay_line(GameState *state, float *y, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+static void perf_overlay_line(GameState *state, float *y, const char *format, ...) {
+    const float size = 28;
+    va_list args;
+    va_start(args, format);
+    const char *line = arena_vprintf(&state->frame_arena, format, args);
+    va_end(args);
+    DrawTextEx(state->font[0], line, (Vector2){16, *y}, size, 0, WHITE);
+    *y += size;
+}
+
+void game_state_draw_perf_overlay(GameState *state) {
+    const ParticleBudget *budget = &state->world->particles.budget;
+    float y = 16;
+    const FrameJitter *jitter = &state->pacing.jitter;
+    perf_overlay_line(state, &y, "FPS: %.0f (%.2f ms)", jitter->mean > 0 ? 1.0 / jitter->mean : 0.0,
+                      frame_time() * 1000.0);
+    perf_overlay_line(state, &y, "Limiter: %s (target %d)%s, jitter %.2f ms, worst %.2f ms, %zu missed, spin %.2f ms",
+                      pacing_limit_name(state->pacing.limit), state->pacing.target_fps,
+                      state->pacing.late_input ? ", late input" : "", jitter->jitter * 1000.0,
+                      jitter->worst * 1000.0, jitter->missed, state->pacing.spin_margin * 1000.0);
+    const LatencyDistribution present =
+        latency_distribution(&state->latency, LATENCY_PRESENTED, &state->frame_arena);
+    perf_overlay_line(state, &y, "Input latency: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms (%zu inputs)",
+                      present.p50 * 1000.0, present.p95 * 1000.0, present.p99 * 1000.0, present.max * 1000.0,
+                      present.count);
+    perf_overlay_line(state, &y, "Input p50: consumed %.2f ms, submitted %.2f ms, EndDrawing %.2f ms",
+                      latency_distribution(&state->latency, LATENCY_CONSUMED, &state->frame_arena).p50 * 1000.0,
+                      latency_distribution(&state->latency, LATENCY_SUBMITTED, &state->frame_arena).p50 * 1000.0,
+                      latency_distribution(&state->latency, LATENCY_END_DRAWING, &state->frame_arena).p50 * 1000.0);
+    perf_overlay_line(state, &y, "Simulation: %s, %zu ticks, %zu stalls", state->sim->running ? "threaded" : "stopped",
+                      state->sim->ticks, state->sim->stalls);
+    perf_overlay_line(state, &y, "Systems: %zu in %zu levels, %zu ran side by side on %zu threads",
+                      state->tick_schedule.count, state->world->schedule_levels, state->world->schedule_parallel_runs,
+                      state->sim_jobs->thread_count + 1);
+    perf_overlay_line(state, &y, "Savestate: %zu KiB, saved in %.1f us, loaded in %.1f us",
+                      state->has_savestate ? world_snapshot_size(&state->savestate) / 1024 : 0,
+                      state->savestate_time * 1e6, state->restore_time * 1e6);
+    perf_overlay_line(state, &y, "Particles: %zu live, budget %.0f%% (%.2f ms avg)", budget->live,
+                      budget->scale * 100.0, budget->frame_time * 1000.0);
+    perf_overlay_line(state, &y, "Particle spawns: %zu requested, %zu spawned, %zu dropped", budget->requested,
+                      budget->spawned, budget->dropped);
+    perf_overlay_line(state, &y, "Particle splat: %s, %zu splats on %zu threads",
+                      state->particle_splat_enabled ? "on" : "off", state->particle_layer.splat_count,
+                      state->jobs->thread_count + 1);
+    perf_overlay_line(state, &y, "Rect batch: %zu quads in %zu draws, %zu culled", state->batch.stats.quads,
+                      state->batch.stats.draws, state->batch.stats.culled);
+    perf_overlay_line(state, &y, "Playfield: 1/%d (%dx%d)%s", state->raw_frame_scale,
+                      state->raw_frame_buffer.texture.width, state->raw_frame_buffer.texture.height,
+                      state->raw_frame_scale == 1 && state->vfx_enabled ? ", pixelized" : "");
+    perf_overlay_line(state, &y, "DRS: %s, %.0f%% (%zu down, %zu up), frame %.2f ms, work %.2f ms",
+                      state->drs.enabled ? "on" : "off", state->drs.fraction * 100.0, state->drs.downscales,
+                      state->drs.upscales, state->drs.frame_time * 1000.0, state->drs.work_time * 1000.0);
+    perf_overlay_line(state, &y, "Render passes: %zu live, %zu culled", state->render_graph.live,
+                      state->render_graph.culled);
+    perf_overlay_line(state, &y, "UI: %zu layouts, %zu renders", state->ui_layouts, state->ui_renders);
+    perf_overlay_line(state, &y, "Text atlas: %zu hits, %zu misses, %zu evictions, %d shelves",
+                      state->text_atlas->hits, state->text_atlas->misses, state->text_atlas->evictions,
+                      state->text_atlas->shelfCount);
+    perf_overlay_line(state, &y, "Text measure: %zu hits, %zu misses, %zu cached", state->text_measure->hits,
+                      state->text_measure->misses, state->text_measure->used);
+    perf_overlay_line(state, &y, "Stage layer: %zu platforms, revision %u", state->stage_layer.batch.count,
+                      state->stage_layer.revision);
+    perf_overlay_line(state, &y, "Pacing: %s (%zu active, %zu idle, %zu unfocused, %zu hidden frames)",
+                      pacing_mode_name(state->pacing.mode), state->pacing.frames[PACING_ACTIVE],
+                      state->pacing.frames[PACING_IDLE], state->pacing.frames[PACING_UNFOCUSED],
+                      state->pacing.frames[PACING_HIDDEN]);
+    perf_overlay_line(state, &y, "Frame arena: %zu / %zu KiB (peak %zu), UI arena: %zu / %zu KiB",
+                      state->frame_arena.used / 1024, state->frame_arena.capacity / 1024,
+                      state->frame_arena.high_water / 1024, state->ui_arena.used / 1024,
+                      state->ui_arena.capacity / 1024);
+}
+
+Stage *load_stages(Arena *scratch, const char *index_file_name, const char *stage_file_name_format) {
     FILE *index_file = fopen(index_file_name, "r");
     size_t n;
     fscanf(index_file, "%zu", &n);
     fclose(index_file);
     Stage *stages = NULL;
     for (size_t i = 0; i < n; i++) {
-        FILE *stage_file = fopen(TextFormat(stage_file_name_format, i), "r");
+        FILE *stage_file = fopen(arena_printf(scratch, stage_file_name_format, i), "r");
         Stage stage;
         fscanf(stage_file, "%f %f", &stage.spawn.x, &stage.spawn.y);
         fscanf(stage_file, "%zu", &stage.count);
@@ -1241,16 +1826,17 @@ Stage *load_stages(const char *index_file_name, const char *stage_file_name_form
                    &stage.spawns[j].height);
         }
         fclose(stage_file);
+        stage_bake(&stage);
         stbds_arrput(stages, stage);
     }
     return stages;
 }
-void save_stages(Stage **stages, const char *index_file_name, const char *stage_file_name_format) {
+void save_stages(Arena *scratch, Stage **stages, const char *index_file_name, const char *stage_file_name_format) {
     FILE *index_file = fopen(index_file_name, "w");
     fprintf(index_file, "%zu", stbds_arrlen(*stages));
     fclose(index_file);
     for (ptrdiff_t i = 0; i < stbds_arrlen(*stages); i++) {
-        FILE *stage_file = fopen(TextFormat(stage_file_name_format, i), "w");
+        FILE *stage_file = fopen(arena_printf(scratch, stage_file_name_format, i), "w");
 
         fprintf(stage_file, "%.2f %.2f\n", (*stages)[i].spawn.x, (*stages)[i].spawn.y);
         fprintf(stage_file, "%zu\n", (*stages)[i].count);
@@ -1267,36 +1853,13 @@ void save_stages(Stage **stages, const char *index_file_name, const char *stage_
     }
 }
 
-void apply_shader(RenderTexture2D *in, RenderTexture2D *out, Shader *shader) {
-    BeginTextureMode(*out);
-    ClearBackground(BLACK);
-    if (shader != NULL) {
-        BeginShaderMode(*shader);
-        const float w = GetMonitorWidth(0);
-        const float h = GetMonitorHeight(0);
-        SetShaderValue(*shader, GetShaderLocation(*shader, "renderWidth"), &w, SHADER_UNIFORM_FLOAT);
-        SetShaderValue(*shader, GetShaderLocation(*shader, "renderHeight"), &h, SHADER_UNIFORM_FLOAT);
-    }
-    DrawTextureRec(in->texture,
-                   (Rectangle){
-                       0,
-                       (float)in->texture.height,
-                       (float)in->texture.width,
-                       -(float)in->texture.height,
-                   },
-                   (Vector2){0, 0}, WHITE);
-    if (shader != NULL) {
-        EndShaderMode();
-    }
-    EndTextureMode();
-}
 
 void draw_centered_text(const char *message, const Font *font, size_t size, Color color, float y) {
     const Vector2 text_size = MeasureTextEx(*font, message, size, 0);
     DrawTextEx(*font, message, (Vector2){screen_centered_position(text_size.x), y}, size, 0, color);
 }
 
-void flash_error(GameState *state, char *message) {
+void flash_error(GameState *state, const char *message) {
     state->error_opacity = 1.0;
     state->error = message;
 }
@@ -1307,15 +1870,15 @@ void flash_error(GameState *state, char *message) {
 #define WOLF(x, y) ecs_wolf_enemy((Vector2){(x), (y)}, (Vector2){64, 20}, 5, 20, 2000, 0, 3)
 #define HEALER(x, y) ecs_healing_enemy((Vector2){(x), (y)}, (Vector2){32, 64}, 5, 9, 0.5, 200)
 
-EnemyWave generate_wave(double strength, const Stage *stage) {
+EnemyWave generate_wave(double strength, const Stage *stage, Rng *rng) {
     EnemyWave wave = NULL;
 
     while (strength > 0) {
-        size_t enemy_type = GetRandomValue(0, 4);
-        size_t which_area = GetRandomValue(0, stage->count_sp - 1);
+        size_t enemy_type = rng_range(rng, 0, 4);
+        size_t which_area = rng_range(rng, 0, stage->count_sp - 1);
         Vector2 pos = (Vector2){
-            GetRandomValue(stage->spawns[which_area].x, stage->spawns[which_area].x + stage->spawns[which_area].width),
-            GetRandomValue(stage->spawns[which_area].y, stage->spawns[which_area].y + stage->spawns[which_area].height),
+            rng_range(rng, stage->spawns[which_area].x, stage->spawns[which_area].x + stage->spawns[which_area].width),
+            rng_range(rng, stage->spawns[which_area].y, stage->spawns[which_area].y + stage->spawns[which_area].height),
         };
         switch (enemy_type) {
         case 0: {
@@ -3,8 +3,14 @@
 
 #include "pickup.h"
 #include "player.h"
+#include "arena.h"
+#include "drs.h"
+#include "latency.h"
+#include "pacing.h"
 #include "particles.h"
 #include "raylib.h"
+#include "schedule.h"
+#include "sim.h"
 #include "wave.h"
 #include <clay/clay.h>
 
@@ -47,6 +53,8 @@ typedef struct {
     size_t wave_number;
     Pickups pickups;
     Particles particles;
+    Rng rng; // Everything random in the gameplay, particles have their own
+    double clock; // Simulation time, advanced by every tick. What entity timestamps are compared against
 
     GamePhase phase;
 
@@ -57,8 +65,6 @@ typedef struct {
     // Assets
     Font font[1];
     Sound ui_button_click_sound;
-    Sound enemy_hit_sound;
-    Sound enemy_die_sound;
     Sound phase_change_sound;
 
     // Intermission screen (upgrades)
@@ -68,21 +74,65 @@ typedef struct {
 
     double volume_label_opacity;
     double vfx_indicator_opacity;
+    bool perf_overlay_enabled;
 
-    char* error;
+    const char* error;
     double error_opacity;
 
     MainMenuType main_menu_type;
 
     // vfx
+    int playfield_scale;  // Configured, see PLAYFIELD_SCALE
+    int raw_frame_scale;  // What `raw_frame_buffer` is currently allocated at
+    DynamicResolution drs; // Renders to a part of `raw_frame_buffer` when frames get slow
+    double frame_started_at;
+    Pacing pacing; // Static screens and hidden windows aren't drawn at full rate
+    Latency latency;
     RenderTexture2D raw_frame_buffer;
     RenderTexture2D ui_frame_buffer;
-    RenderTexture2D final_frame_buffer;
-    Shader pixelizer;
+    CompositeShader composite;
+    RenderGraph render_graph;
     bool vfx_enabled;
+    ParticleLayer particle_layer;
+    bool particle_splat_enabled;
+    RectBatch batch;
+    StageLayer stage_layer;
+
+    // Worker threads for data parallel jobs of the main thread
+    JobPool *jobs;
+    // Worker threads of the simulation, apart so that the tick and the particle splat don't wait for each other
+    JobPool *sim_jobs;
+    // Runs `game_state_tick` on its own thread while a wave is on, the world is drawn from its snapshots then.
+    // Everything else only touches the world while the simulation is stopped
+    Sim *sim;
+    Schedule tick_schedule; // The systems `game_state_tick` runs
+    WorldSnapshot still; // The world while the simulation thread doesn't own it
+    const WorldSnapshot *world; // What this frame shows
+    // Taken with F5 and loaded with F9
+    WorldSnapshot savestate;
+    bool has_savestate;
+    double savestate_time;
+    double restore_time;
+    InputFrame input;
+    // Reset at the start of every frame
+    Arena frame_arena;
+    // Reset whenever the UI is laid out again
+    Arena ui_arena;
 
     // clay ui
     Clay_Arena clay_memory;
+    // Retained between frames, only laid out again when `game_state_ui_key` or the input changes
+    Clay_RenderCommandArray ui_commands;
+    uint64_t ui_key;
+    bool ui_layout_valid;
+    bool ui_buffer_valid; // `ui_frame_buffer` holds `ui_commands`
+    bool ui_hud_drawn;    // ...and a HUD that has to be cleared again
+    double ui_input_at;
+    size_t ui_layouts;
+    size_t ui_renders;
+    // Text runs of the UI rasterized once, see `Clay_Raylib_PrepareText`
+    struct Raylib_TextAtlas *text_atlas;
+    struct Raylib_TextMeasureCache *text_measure;
 
 
     struct {
@@ -109,12 +159,30 @@ void game_state(GameState *state);
 void game_state_update(GameState *state);
 // Draws a single frame of the game state
 void game_state_frame(GameState *state); 
+// (Re)allocates the playfield buffer when the configured scale or the vfx toggle changed
+void game_state_resize_playfield(GameState *state);
+// Part of `raw_frame_buffer` the playfield is rendered to this frame
+Rectangle game_state_playfield_viewport(const GameState *state);
+// `camera` adjusted for drawing into the playfield viewport
+Camera2D game_state_playfield_camera(const GameState *state);
 // Draws the stage, enemies, bullets, player
-void game_state_draw_playfield(const GameState *state); 
+void game_state_draw_playfield(GameState *state);
 Clay_RenderCommandArray game_state_draw_ui(GameState *state);
-
-
-void game_state_update_gp_main(GameState *state, float dt);
+// Hash of everything the UI of the current phase shows
+uint64_t game_state_ui_key(const GameState *state);
+// Volume, vfx and error flashes and the perf overlay, drawn straight into the UI buffer
+void game_state_draw_hud(GameState *state);
+// Whether `game_state_draw_hud` would draw anything visible
+bool game_state_hud_visible(const GameState *state);
+// Whether anything on screen changes without input
+bool game_state_animating(const GameState *state);
+// Frame timings and subsystem counters, toggled with F3
+void game_state_draw_perf_overlay(GameState *state);
+
+
+// One tick of a wave, runs on the simulation thread and spreads the systems of `tick_schedule` over the job pool.
+// Returns the phase the wave asks for, GP_MAIN to go on, and sets `consumed_at` when it acted on input
+GamePhase game_state_tick(GameState *state, const Camera2D *camera, Rectangle view, double *consumed_at);
 void game_state_update_gp_dead(GameState *state, float dt);
 void game_state_update_gp_paused(GameState *state, float dt);
 void game_state_update_gp_transition(GameState *state, float dt);
@@ -123,25 +191,24 @@ void game_state_update_editor(GameState *state, float dt);
 
 void game_state_update_ui_internals();
 void game_state_update_camera(Camera2D *camera, const TransformComp *target);
+// The part of the world `camera` currently shows
+Rectangle camera_view_rect(const Camera2D *camera);
 
 void game_state_phase_change(GameState *state, GamePhase next);
 
 void draw_centered_text(const char* message, const Font* font, size_t size, Color color, float y);
 double screen_centered_position(double w);
 
-EnemyWave generate_wave(double strength, const Stage *stage);
+EnemyWave generate_wave(double strength, const Stage *stage, Rng *rng);
 
 
-// Renders the `in` texture into `out` assuming they are the same size
-// with the shader in `shader` unless `shader` is NULL then just blit 
-// `in` -> `out`
-void apply_shader(RenderTexture2D *in, RenderTexture2D *out, Shader *shader);
 
 void ui_label(const char *text, uint16_t size, Color c, Clay_TextAlignment aligment);
-void flash_error(GameState* state, char* message);
+void flash_error(GameState* state, const char* message);
 
-Stage* load_stages(const char* index_file_name, const char* stage_file_name_format);
-void save_stages(Stage** stages, const char* index_file_name, const char* stage_file_name_format);
+// File names are formatted into `scratch`
+Stage* load_stages(Arena* scratch, const char* index_file_name, const char* stage_file_name_format);
+void save_stages(Arena* scratch, Stage** stages, const char* index_file_name, const char* stage_file_name_format);
 #define ui_container(id_, dir, width, height, pad, c_gap)  \
     CLAY({ \
         .id = id_, \
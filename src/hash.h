@@ -0,0 +1,12 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FNV1A_OFFSET 0xcbf29ce484222325ull
+
+// FNV-1a over `size` bytes of `data`, continuing from `hash` (start with `FNV1A_OFFSET`)
+uint64_t fnv1a(uint64_t hash, const void *data, size_t size);
+
+#endif
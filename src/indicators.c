@@ -0,0 +1,41 @@
+#include "indicators.h"
+#include "raymath.h"
+#include <math.h>
+
+Indicators indicators_new(Vector2 origin, Rectangle view) {
+    Indicators indicators = {.origin = origin, .view = view};
+    for (size_t i = 0; i < INDICATOR_SECTORS; i++) {
+        indicators.nearest[i] = INFINITY;
+    }
+    return indicators;
+}
+
+void indicators_add(Indicators *indicators, Rectangle target) {
+    if (CheckCollisionRecs(target, indicators->view)) {
+        return;
+    }
+    const float dx = target.x - indicators->origin.x;
+    const float dy = target.y - indicators->origin.y;
+    const float angle = atan2f(dy, dx) + PI;
+    size_t sector = angle * (INDICATOR_SECTORS / (2 * PI));
+    sector = sector < INDICATOR_SECTORS ? sector : 0;
+    indicators->count[sector]++;
+    indicators->nearest[sector] = fminf(indicators->nearest[sector], sqrtf(dx * dx + dy * dy));
+}
+
+void indicators_draw(const Indicators *indicators, Color color, RectBatch *batch) {
+    for (size_t i = 0; i < INDICATOR_SECTORS; i++) {
+        if (indicators->count[i] == 0) {
+            continue;
+        }
+        // Points through the middle of the sector
+        const float angle = (i + 0.5f) * (2 * PI / INDICATOR_SECTORS) - PI;
+        const float thickness = fminf(3 + 2 * log2f(indicators->count[i] + 1), 15);
+        const float closeness = 1 - Clamp(indicators->nearest[i] / INDICATOR_FAR, 0, 1);
+        const float alpha = Clamp(color.a / 255.0f * (0.5f + 1.5f * closeness), 0, 1);
+        rect_batch_push_rotated(batch,
+                                (Rectangle){indicators->origin.x, indicators->origin.y, INDICATOR_LENGTH, thickness},
+                                (Vector2){0, thickness / 2}, (Vector2){cosf(angle), sinf(angle)},
+                                ColorAlpha(color, alpha));
+    }
+}
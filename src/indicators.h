@@ -0,0 +1,27 @@
+#ifndef INDICATORS_H
+#define INDICATORS_H
+
+#include "render.h"
+#include <raylib.h>
+#include <stddef.h>
+
+#define INDICATOR_SECTORS 32
+#define INDICATOR_LENGTH 50.0f
+// Distance at which an indicator has faded to its dimmest
+#define INDICATOR_FAR 3000.0f
+
+// Offscreen things binned by the direction they are in as seen from `origin`, so that a horde only takes one
+// arrow per direction instead of one per entity
+typedef struct {
+    Vector2 origin;
+    Rectangle view; // Things inside of it can be seen and don't need an indicator
+    size_t count[INDICATOR_SECTORS];
+    float nearest[INDICATOR_SECTORS];
+} Indicators;
+
+Indicators indicators_new(Vector2 origin, Rectangle view);
+void indicators_add(Indicators *indicators, Rectangle target);
+// One arrow per occupied sector, thicker the more there are in it and more opaque the closer the nearest one is
+void indicators_draw(const Indicators *indicators, Color color, RectBatch *batch);
+
+#endif
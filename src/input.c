@@ -0,0 +1,52 @@
+#include "input.h"
+
+static _Thread_local const InputFrame *current;
+
+InputFrame input_capture(double sampled_at, float dt) {
+    InputFrame frame = {.mouse_position = GetMousePosition(), .sampled_at = sampled_at, .dt = dt};
+    for (int key = 0; key < INPUT_MAX_KEYS; key++) {
+        if (IsKeyDown(key)) {
+            frame.keys_down[key / 64] |= 1ull << (key % 64);
+        }
+        if (IsKeyPressed(key)) {
+            frame.keys_pressed[key / 64] |= 1ull << (key % 64);
+        }
+    }
+    for (int button = 0; button < INPUT_MAX_BUTTONS; button++) {
+        if (IsMouseButtonDown(button)) {
+            frame.buttons_down |= 1 << button;
+        }
+        if (IsMouseButtonPressed(button)) {
+            frame.buttons_pressed |= 1 << button;
+        }
+    }
+    return frame;
+}
+
+void input_use(const InputFrame *frame) {
+    current = frame;
+}
+
+const InputFrame *input_current() {
+    return current;
+}
+
+bool input_key_down(int key) {
+    return key >= 0 && key < INPUT_MAX_KEYS && (current->keys_down[key / 64] >> (key % 64) & 1);
+}
+
+bool input_key_pressed(int key) {
+    return key >= 0 && key < INPUT_MAX_KEYS && (current->keys_pressed[key / 64] >> (key % 64) & 1);
+}
+
+bool input_button_down(int button) {
+    return button >= 0 && button < INPUT_MAX_BUTTONS && (current->buttons_down >> button & 1);
+}
+
+bool input_button_pressed(int button) {
+    return button >= 0 && button < INPUT_MAX_BUTTONS && (current->buttons_pressed >> button & 1);
+}
+
+Vector2 input_mouse_position() {
+    return current->mouse_position;
+}
@@ -0,0 +1,36 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "raylib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Highest raylib key code is below this
+#define INPUT_MAX_KEYS 512
+#define INPUT_MAX_BUTTONS 8
+
+// Keyboard and mouse state of one frame, copied out of raylib so it can be handed to another thread
+typedef struct {
+    uint64_t keys_down[INPUT_MAX_KEYS / 64];
+    uint64_t keys_pressed[INPUT_MAX_KEYS / 64];
+    uint8_t buttons_down;
+    uint8_t buttons_pressed;
+    Vector2 mouse_position;
+    double sampled_at; // When the input was polled, on `pacing_clock`
+    float dt;          // `frame_time` of the frame it was polled for
+} InputFrame;
+
+// Has to be called on the thread that polls the events
+InputFrame input_capture(double sampled_at, float dt);
+// The frame the `input_*` queries of the calling thread answer from, until the next call
+void input_use(const InputFrame *frame);
+const InputFrame *input_current();
+
+// Same as raylib's `IsKeyDown`, `IsKeyPressed`... but safe on any thread, see `input_use`
+bool input_key_down(int key);
+bool input_key_pressed(int key);
+bool input_button_down(int button);
+bool input_button_pressed(int button);
+Vector2 input_mouse_position();
+
+#endif
@@ -0,0 +1,94 @@
+#include "job_pool.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+// Takes and runs jobs from the current batch until there are none left, `pool->lock` has to be held
+static void job_pool_drain(JobPool *pool) {
+    while (pool->next_job < pool->job_count) {
+        const size_t job = pool->next_job++;
+        pthread_mutex_unlock(&pool->lock);
+        pool->fn(pool->user_data, job);
+        pthread_mutex_lock(&pool->lock);
+        if (++pool->jobs_done == pool->job_count) {
+            pthread_cond_broadcast(&pool->work_done);
+        }
+    }
+}
+
+static void *job_pool_worker(void *arg) {
+    JobPool *pool = arg;
+    uint64_t seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (!pool->quit && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->quit) {
+            break;
+        }
+        seen = pool->generation;
+        job_pool_drain(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+JobPool *job_pool_new(size_t max_workers) {
+    JobPool *pool = calloc(1, sizeof(JobPool));
+    pthread_mutex_init(&pool->run_lock, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t workers = cores > 1 ? cores - 1 : 0;
+    if (workers > max_workers) {
+        workers = max_workers;
+    }
+    if (workers > JOB_POOL_MAX_THREADS) {
+        workers = JOB_POOL_MAX_THREADS;
+    }
+    for (size_t i = 0; i < workers; i++) {
+        if (pthread_create(&pool->threads[pool->thread_count], NULL, job_pool_worker, pool) == 0) {
+            pool->thread_count++;
+        }
+    }
+    return pool;
+}
+
+void job_pool_run(JobPool *pool, size_t count, JobFn fn, void *user_data) {
+    if (count == 0) {
+        return;
+    }
+    pthread_mutex_lock(&pool->run_lock);
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->user_data = user_data;
+    pool->job_count = count;
+    pool->next_job = 0;
+    pool->jobs_done = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+
+    job_pool_drain(pool);
+    while (pool->jobs_done < pool->job_count) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+void job_pool_free(JobPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_cond_destroy(&pool->work_done);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->run_lock);
+    free(pool);
+}
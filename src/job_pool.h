@@ -0,0 +1,44 @@
+#ifndef JOB_POOL_H
+#define JOB_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define JOB_POOL_MAX_THREADS 16
+
+// Runs `fn(user_data, index)` once for every index of a batch
+typedef void (*JobFn)(void *user_data, size_t index);
+
+// A fixed set of worker threads that split batches of small jobs between themselves and the caller
+typedef struct {
+    pthread_t threads[JOB_POOL_MAX_THREADS];
+    size_t thread_count;
+
+    // Held for a whole batch, a pool is meant to have a single submitter but a second one waits instead of breaking
+    pthread_mutex_t run_lock;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+
+    // The batch currently running, guarded by `lock`
+    JobFn fn;
+    void *user_data;
+    size_t job_count;
+    size_t next_job;
+    size_t jobs_done;
+    uint64_t generation;
+    bool quit;
+} JobPool;
+
+// Starts one worker less than there are cores but at most `max_workers`, the thread calling `job_pool_run` works
+// too. The pool is heap allocated since the workers hold on to its address
+// Threads that run batches at the same time should each have their own pool, they'd wait for each other otherwise
+JobPool *job_pool_new(size_t max_workers);
+// Runs a batch of `count` jobs and returns once all of them are done, waits for a batch another thread is running
+// first. Jobs must not run batches of their own
+void job_pool_run(JobPool *pool, size_t count, JobFn fn, void *user_data);
+void job_pool_free(JobPool *pool);
+
+#endif
@@ -0,0 +1,83 @@
+#include "latency.h"
+#include "pacing.h"
+#include "raylib.h"
+#include <stdlib.h>
+
+void latency_begin_frame(Latency *latency, double sampled_at) {
+    latency->sampled_at = sampled_at;
+    latency->consumed = false;
+}
+
+void latency_consumed(Latency *latency, double at) {
+    if (!latency->consumed) {
+        latency->consumed = true;
+        latency->at[LATENCY_CONSUMED] = at;
+    }
+}
+
+void latency_mark(Latency *latency, LatencyStage stage) {
+    latency->at[stage] = pacing_clock();
+}
+
+void latency_end_frame(Latency *latency, double presented_at) {
+    if (!latency->consumed) {
+        return;
+    }
+    latency->at[LATENCY_PRESENTED] = presented_at;
+    LatencySample *sample = &latency->samples[latency->sample_count++ % LATENCY_SAMPLES];
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        sample->at[i] = latency->at[i] - latency->sampled_at;
+    }
+    size_t bucket = sample->at[LATENCY_PRESENTED] / LATENCY_BUCKET_WIDTH;
+    latency->histogram[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS]++;
+}
+
+static int compare_floats(const void *a, const void *b) {
+    const float x = *(const float *)a;
+    const float y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+LatencyDistribution latency_distribution(const Latency *latency, LatencyStage stage, Arena *scratch) {
+    const size_t count = latency->sample_count < LATENCY_SAMPLES ? latency->sample_count : LATENCY_SAMPLES;
+    float *values = arena_array(scratch, float, count);
+    if (count == 0 || values == NULL) {
+        return (LatencyDistribution){0};
+    }
+    for (size_t i = 0; i < count; i++) {
+        values[i] = latency->samples[i].at[stage];
+    }
+    qsort(values, count, sizeof(float), compare_floats);
+    return (LatencyDistribution){
+        .p50 = values[count / 2],
+        .p95 = values[count * 95 / 100],
+        .p99 = values[count * 99 / 100],
+        .max = values[count - 1],
+        .count = count,
+    };
+}
+
+// Upper edge of the bucket the `fraction` of the histogram falls into
+static float latency_histogram_percentile(const Latency *latency, double fraction) {
+    const size_t rank = latency->sample_count * fraction;
+    size_t seen = 0;
+    for (size_t i = 0; i <= LATENCY_BUCKETS; i++) {
+        seen += latency->histogram[i];
+        if (seen > rank) {
+            return (i + 1) * LATENCY_BUCKET_WIDTH;
+        }
+    }
+    return (LATENCY_BUCKETS + 1) * LATENCY_BUCKET_WIDTH;
+}
+
+void latency_report(const Latency *latency) {
+    if (latency->sample_count == 0) {
+        TraceLog(LOG_INFO, "LATENCY: no input samples");
+        return;
+    }
+    TraceLog(LOG_INFO, "LATENCY: %zu inputs, input to present p50 %.2f ms, p95 %.2f ms, p99 %.2f ms%s",
+             latency->sample_count, latency_histogram_percentile(latency, 0.5) * 1000.0,
+             latency_histogram_percentile(latency, 0.95) * 1000.0,
+             latency_histogram_percentile(latency, 0.99) * 1000.0,
+             latency->histogram[LATENCY_BUCKETS] > 0 ? " (some over the histogram's range)" : "");
+}
@@ -0,0 +1,59 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "arena.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Input samples kept for the overlay's distributions
+#define LATENCY_SAMPLES 256
+// Whole run histogram of the end to end latency, for the report on exit
+#define LATENCY_BUCKET_WIDTH 0.00025
+#define LATENCY_BUCKETS 800
+
+// Points in a frame an input goes through, each is measured from when the input was polled
+typedef enum {
+    LATENCY_CONSUMED,    // The tick that acted on it
+    LATENCY_SUBMITTED,   // The final composite was submitted
+    LATENCY_END_DRAWING, // `EndDrawing` returned
+    LATENCY_PRESENTED,   // The swap returned, the display adds up to one more refresh to this
+    LATENCY_STAGE_COUNT,
+} LatencyStage;
+
+typedef struct {
+    float at[LATENCY_STAGE_COUNT];
+} LatencySample;
+
+typedef struct {
+    float p50;
+    float p95;
+    float p99;
+    float max;
+    size_t count;
+} LatencyDistribution;
+
+// Follows inputs from being polled to reaching the display, times are on `pacing_clock`
+typedef struct {
+    // The frame being run
+    double sampled_at;
+    double at[LATENCY_STAGE_COUNT];
+    bool consumed;
+
+    LatencySample samples[LATENCY_SAMPLES];
+    size_t sample_count; // All ever taken, the ring holds the last `LATENCY_SAMPLES`
+    size_t histogram[LATENCY_BUCKETS + 1]; // The last bucket takes everything over
+} Latency;
+
+// `sampled_at` is when the input of this frame was polled
+void latency_begin_frame(Latency *latency, double sampled_at);
+// Some input was acted on this frame, `at` on `pacing_clock`
+void latency_consumed(Latency *latency, double at);
+void latency_mark(Latency *latency, LatencyStage stage);
+// Takes a sample if input was consumed, `presented_at` is when the swap returned
+void latency_end_frame(Latency *latency, double presented_at);
+// Distribution of `stage` over the recent samples
+LatencyDistribution latency_distribution(const Latency *latency, LatencyStage stage, Arena *scratch);
+// Logs the end to end distribution of the whole run
+void latency_report(const Latency *latency);
+
+#endif
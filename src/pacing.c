@@ -0,0 +1,202 @@
+#include "pacing.h"
+#include "raylib.h"
+#include "timing_utilities.h"
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+
+#define PACING_SMOOTHING 0.05f
+
+Pacing pacing_new(PacingLimit limit) {
+    const int refresh_rate = GetMonitorRefreshRate(GetCurrentMonitor());
+    Pacing pacing = {
+        .mode = PACING_ACTIVE,
+        .target_fps = refresh_rate > 0 ? refresh_rate : PACING_DEFAULT_TARGET_FPS,
+        .animated_at = GetTime(),
+        .spin_margin = PACING_MAX_SPIN_MARGIN,
+    };
+    pacing_set_limit(&pacing, limit);
+    return pacing;
+}
+
+void pacing_set_limit(Pacing *pacing, PacingLimit limit) {
+    if (limit == PACING_LIMIT_VSYNC) {
+        SetWindowState(FLAG_VSYNC_HINT);
+    } else {
+        ClearWindowState(FLAG_VSYNC_HINT);
+    }
+    pacing->limit = limit;
+    pacing->deadline = pacing_clock();
+    pacing->jitter = (FrameJitter){0};
+}
+
+double pacing_clock() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Sleeps for most of the time left and spins the rest, sleeps alone overshoot by up to a millisecond or two
+static void pacing_wait_until(Pacing *pacing, double deadline) {
+    const double sleep_until = deadline - pacing->spin_margin;
+    if (pacing_clock() < sleep_until) {
+        const struct timespec wake = {
+            .tv_sec = (time_t)sleep_until,
+            .tv_nsec = (long)((sleep_until - (time_t)sleep_until) * 1e9),
+        };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR) {
+        }
+        // Grows right away when the scheduler is late, shrinks slowly when it's on time again
+        const double overslept = (pacing_clock() - sleep_until) * 1.5;
+        const double margin = overslept > pacing->spin_margin
+                                  ? overslept
+                                  : pacing->spin_margin + (overslept - pacing->spin_margin) * PACING_SMOOTHING;
+        pacing->spin_margin = fmin(fmax(margin, PACING_MIN_SPIN_MARGIN), PACING_MAX_SPIN_MARGIN);
+    }
+    while (pacing_clock() < deadline) {
+    }
+}
+
+static void pacing_set_mode(Pacing *pacing, PacingMode mode) {
+    if (mode == PACING_IDLE && pacing->mode != PACING_IDLE) {
+        EnableEventWaiting();
+    } else if (mode != PACING_IDLE && pacing->mode == PACING_IDLE) {
+        DisableEventWaiting();
+    }
+    pacing->mode = mode;
+}
+
+// The next deadline `period` after the last one, a frame that is already late isn't followed by rushed ones
+static double pacing_next_deadline(Pacing *pacing, double period) {
+    const double now = pacing_clock();
+    pacing->deadline += period;
+    if (pacing->deadline < now) {
+        pacing->deadline = now;
+    }
+    return pacing->deadline;
+}
+
+static void pacing_record_swap(Pacing *pacing, double expected_interval) {
+    const double now = pacing_clock();
+    const float interval = now - pacing->swapped_at;
+    pacing->swapped_at = now;
+    if (!pacing->steady) {
+        return;
+    }
+    FrameJitter *jitter = &pacing->jitter;
+    if (jitter->mean == 0) {
+        jitter->mean = interval;
+    }
+    jitter->mean += (interval - jitter->mean) * PACING_SMOOTHING;
+    jitter->jitter += (fabsf(interval - jitter->mean) - jitter->jitter) * PACING_SMOOTHING;
+    if (expected_interval > 0 && interval > expected_interval * 1.5) {
+        jitter->missed++;
+    }
+    jitter->window_worst = fmaxf(jitter->window_worst, interval);
+    if (now - jitter->window_started >= 1.0) {
+        jitter->worst = jitter->window_worst;
+        jitter->window_worst = 0;
+        jitter->window_started = now;
+    }
+}
+
+bool pacing_begin_frame(Pacing *pacing) {
+    if (IsWindowHidden() || IsWindowMinimized()) {
+        pacing_set_mode(pacing, PACING_HIDDEN);
+        pacing->steady = false;
+        pacing->frames[PACING_HIDDEN]++;
+        WaitTime(PACING_HIDDEN_POLL);
+        PollInputEvents();
+        pacing->input_sampled_at = pacing_clock();
+        return false;
+    }
+    // Input while idle gets a frame right away, `pacing_end_frame` decides whether it started something
+    pacing->frame_started_at = pacing_clock();
+    frame_time_tick();
+    return true;
+}
+
+void pacing_end_frame(Pacing *pacing, bool animating) {
+    const double now = GetTime();
+    if (animating) {
+        pacing->animated_at = now;
+    }
+    pacing->frames[pacing->mode]++;
+    pacing->work_time += (pacing_clock() - pacing->frame_started_at - pacing->work_time) * PACING_SMOOTHING;
+
+    PacingMode next = PACING_ACTIVE;
+    if (now - pacing->animated_at >= PACING_IDLE_DELAY) {
+        next = PACING_IDLE;
+    } else if (!IsWindowFocused()) {
+        next = PACING_UNFOCUSED;
+    }
+    pacing->steady = pacing->mode == PACING_ACTIVE && next == PACING_ACTIVE;
+    pacing_set_mode(pacing, next);
+
+    // How far apart the limiter puts frames, 0 when something else paces them
+    double period = pacing->limit == PACING_LIMIT_TARGET ? 1.0 / pacing->target_fps : 0;
+    if (next == PACING_UNFOCUSED) {
+        period = fmax(period, 1.0 / PACING_UNFOCUSED_FPS);
+    } else if (next == PACING_IDLE) {
+        // Polling blocks until the next event
+        period = 0;
+    }
+    const int refresh_rate = GetMonitorRefreshRate(GetCurrentMonitor());
+    const double refresh_period = refresh_rate > 0 ? 1.0 / refresh_rate : 0;
+
+    if (period > 0 && !pacing->late_input) {
+        // Input was sampled right after the last swap, the finished frame waits for its deadline
+        pacing_wait_until(pacing, pacing_next_deadline(pacing, period));
+    }
+    SwapScreenBuffer();
+    double expected_interval = period;
+    if (period == 0 && pacing->limit == PACING_LIMIT_VSYNC) {
+        expected_interval = refresh_period;
+    }
+    pacing_record_swap(pacing, expected_interval);
+
+    if (pacing->late_input && next != PACING_IDLE) {
+        // Input is sampled just early enough for the usual amount of work to be done by the next deadline
+        double present_at = 0;
+        if (period > 0) {
+            present_at = pacing_next_deadline(pacing, period);
+        } else if (pacing->limit == PACING_LIMIT_VSYNC && refresh_period > 0) {
+            present_at = pacing->swapped_at + refresh_period;
+        }
+        if (present_at > 0) {
+            pacing_wait_until(pacing, present_at - pacing->work_time - PACING_LATE_INPUT_SLACK);
+        }
+    }
+    PollInputEvents();
+    pacing->input_sampled_at = pacing_clock();
+}
+
+const char *pacing_mode_name(PacingMode mode) {
+    switch (mode) {
+    case PACING_ACTIVE:
+        return "active";
+    case PACING_IDLE:
+        return "idle";
+    case PACING_UNFOCUSED:
+        return "unfocused";
+    case PACING_HIDDEN:
+        return "hidden";
+    case PACING_MODE_COUNT:
+        break;
+    }
+    return "?";
+}
+
+const char *pacing_limit_name(PacingLimit limit) {
+    switch (limit) {
+    case PACING_LIMIT_VSYNC:
+        return "vsync";
+    case PACING_LIMIT_TARGET:
+        return "target";
+    case PACING_LIMIT_UNCAPPED:
+        return "uncapped";
+    case PACING_LIMIT_COUNT:
+        break;
+    }
+    return "?";
+}
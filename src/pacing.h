@@ -0,0 +1,85 @@
+#ifndef PACING_H
+#define PACING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// NOTE: raylib has to be built with SUPPORT_CUSTOM_FRAME_CONTROL (the Makefile's `raylib` target does), buffers
+// are swapped, input is polled and frames are limited here instead of in `EndDrawing`
+
+// How long a screen has to stay still before frames are only drawn on events
+#define PACING_IDLE_DELAY 0.5
+// Cap while the window is visible but something else has the focus
+#define PACING_UNFOCUSED_FPS 30
+// How often a hidden window looks whether it's back
+#define PACING_HIDDEN_POLL 0.1
+// Used for the target mode when the monitor doesn't report its refresh rate
+#define PACING_DEFAULT_TARGET_FPS 144
+// Sleeps wake up this much before a deadline and spin the rest, the margin adapts to how late the scheduler is
+#define PACING_MIN_SPIN_MARGIN 0.0002
+#define PACING_MAX_SPIN_MARGIN 0.004
+// With late input sampling, room left for the work of a frame to take longer than usual
+#define PACING_LATE_INPUT_SLACK 0.001
+
+typedef enum {
+    PACING_ACTIVE,    // Every frame, as fast as the limit allows
+    PACING_IDLE,      // Nothing moves, a frame is only drawn when an event comes in
+    PACING_UNFOCUSED, // Capped at `PACING_UNFOCUSED_FPS`
+    PACING_HIDDEN,    // Minimized or hidden, nothing is simulated or drawn
+    PACING_MODE_COUNT,
+} PacingMode;
+
+typedef enum {
+    PACING_LIMIT_VSYNC,    // The swap waits for the display
+    PACING_LIMIT_TARGET,   // No vsync, frames are presented on `target_fps` deadlines by the limiter
+    PACING_LIMIT_UNCAPPED, // As fast as possible
+    PACING_LIMIT_COUNT,
+} PacingLimit;
+
+// How evenly frames reach the swap chain, intervals are in seconds
+typedef struct {
+    float mean;    // Smoothed interval between two swaps
+    float jitter;  // Smoothed deviation from `mean`
+    float worst;   // Longest interval of the last second
+    size_t missed; // Intervals more than half again as long as the limit asked for
+    float window_worst;
+    double window_started;
+} FrameJitter;
+
+// Frame pacing, decides per frame how soon the next one is needed and when it starts
+typedef struct {
+    PacingMode mode;
+    PacingLimit limit;
+    int target_fps;
+    // Waits before sampling input instead of after, so input is as fresh as possible when the simulation runs.
+    // Frames reach the display as late as before, but the work they take shows up as jitter
+    bool late_input;
+
+    double animated_at;
+    // On the limiter's clock, see `pacing_clock`
+    double frame_started_at;
+    double swapped_at;
+    double input_sampled_at; // Input of the frame about to run was polled
+    double deadline;
+    double spin_margin;
+    float work_time; // Smoothed, from the input being sampled until the frame is handed to the swap chain
+
+    // This frame and the one before ran at full rate, only then do frame times say anything about performance
+    bool steady;
+    size_t frames[PACING_MODE_COUNT];
+    FrameJitter jitter;
+} Pacing;
+
+Pacing pacing_new(PacingLimit limit);
+void pacing_set_limit(Pacing *pacing, PacingLimit limit);
+// Has to come first in a frame, false if the window is hidden and the frame should be skipped entirely
+bool pacing_begin_frame(Pacing *pacing);
+// Picks the mode of the next frame, presents this one and samples the input of the next one. Goes right after
+// `EndDrawing`. `animating` is whether anything on screen changes without input
+void pacing_end_frame(Pacing *pacing, bool animating);
+// Monotonic seconds, the limiter doesn't go through raylib's timer
+double pacing_clock();
+const char *pacing_mode_name(PacingMode mode);
+const char *pacing_limit_name(PacingLimit limit);
+
+#endif
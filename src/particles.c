@@ -2,57 +2,234 @@
 #include "ecs.h"
 #include "raylib.h"
 #include "raymath.h"
-#include "stb_ds_helper.h"
+#include "static_config.h"
 #include "timing_utilities.h"
+#include <math.h>
 #include <stb_ds.h>
 #include <stddef.h>
+#include <string.h>
 
-void particles_push(Particles *particles, Particle p) {
-    stbds_arrput((*particles), p);
+Particles particles_new() {
+    return (Particles){
+        .cosmetic = NULL,
+        .budget = {.frame_time = PARTICLE_TARGET_FRAME_TIME, .scale = 1},
+        .rng = rng_new(PARTICLE_RNG_SEED),
+    };
+}
+
+void particles_budget_update(Particles *particles, float frame_time, Rectangle view) {
+    ParticleBudget *budget = &particles->budget;
+    budget->frame_time = Lerp(budget->frame_time, frame_time, 0.1f);
+    budget->view = view;
+
+    // Cosmetic particles are spawned in order and none outlives the longest lifetime, so the expired ones are at
+    // the front
+    ptrdiff_t expired = 0;
+    while (expired < stbds_arrlen(particles->cosmetic) &&
+           world_time_since(particles->cosmetic[expired].spawned_at) > PARTICLE_LIFETIME + 1) {
+        expired++;
+    }
+    stbds_arrdeln(particles->cosmetic, 0, expired);
+    budget->live = stbds_arrlen(particles->cosmetic);
+
+    const float load_scale = Clamp(PARTICLE_TARGET_FRAME_TIME / budget->frame_time, PARTICLE_MIN_SCALE, 1);
+    const float count_scale =
+        Clamp((PARTICLE_HARD_MAX - (float)budget->live) / (PARTICLE_HARD_MAX - PARTICLE_SOFT_MAX), 0, 1);
+    const float target = fminf(load_scale, count_scale);
+    // Back off right away, recover slowly so it doesn't oscillate
+    if (target < budget->scale) {
+        budget->scale = target;
+    } else {
+        budget->scale = Lerp(budget->scale, target, 0.02f);
+    }
+}
+
+// How many of `n` particles spawned at `pos` fit in the budget
+static int particles_budget_allow(ParticleBudget *budget, int n, Vector2 pos) {
+    float priority = 1;
+    if (budget->view.width > 0 && !CheckCollisionPointRec(pos, budget->view)) {
+        // Offscreen spawns fade out with the distance to the camera and stop altogether at twice the view size
+        const Vector2 center = {budget->view.x + budget->view.width / 2, budget->view.y + budget->view.height / 2};
+        const float radius = Vector2Length((Vector2){budget->view.width / 2, budget->view.height / 2});
+        priority = Clamp(1 - (Vector2Distance(center, pos) - radius) / radius, 0, 1) * 0.5f;
+    }
+    int allowed = n * budget->scale * priority + 0.5f;
+    if (budget->live + allowed > PARTICLE_HARD_MAX) {
+        allowed = budget->live < PARTICLE_HARD_MAX ? PARTICLE_HARD_MAX - budget->live : 0;
+    }
+    budget->live += allowed;
+    budget->requested += n;
+    budget->spawned += allowed;
+    budget->dropped += n - allowed;
+    return allowed;
 }
 
 void particles_spawn_n_in_dir(Particles *particles, int n, Color c, Vector2 dir, Vector2 pos) {
-    Particle base_particle = {
-        .created_at = GetTime(),
-        .active = true,
-        .color = c,
-        .transform = TRANSFORM(pos.x, pos.y, 8, 8),
-        .physics = DEFAULT_PHYSICS(),
-    };
+    const double now = world_time();
+    n = particles_budget_allow(&particles->budget, n, pos);
+    const float lifetime_scale = fmaxf(particles->budget.scale, 0.25f);
+    Rng *rng = &particles->rng;
     for (int i = 0; i < n; i++) {
         const Vector2 unique_rotation =
-            Vector2Scale(Vector2Rotate(dir, GetRandomValue(-100, 100) / 100.0), PARTICLE_VELOCITY);
-        const Color unique_color = ColorBrightness(c, GetRandomValue(0, 20) / 100.0);
-        particles_push(particles, (Particle){.active = true,
-                                             .created_at = base_particle.created_at + GetRandomValue(0, 10) / 10.0,
-                                             .physics = (PhysicsComp){.grounded = false, .velocity = unique_rotation},
-                                             .color = unique_color,
-                                             .transform = base_particle.transform});
-    }
-}
-void particles_draw(const Particles *particles) {
-    for (ptrdiff_t i = 0; i < stbds_arrlen(*particles); i++) {
-        const Particle *p = &(*particles)[i];
-        if (p->active) {
-            DrawRectangleRec(p->transform.rect,
-                             ColorAlpha(p->color, ((time_delta(p->created_at) / PARTICLE_LIFETIME) - 1) * -1));
+            Vector2Scale(Vector2Rotate(dir, rng_range(rng, -100, 100) / 100.0), PARTICLE_VELOCITY);
+        const Color unique_color = ColorBrightness(c, rng_range(rng, 0, 20) / 100.0);
+        stbds_arrput(particles->cosmetic, ((CosmeticParticle){
+                                              .origin = pos,
+                                              .velocity = unique_rotation,
+                                              .color = unique_color,
+                                              .spawned_at = now,
+                                              .lifetime = (PARTICLE_LIFETIME + rng_range(rng, 0, 10) / 10.0) *
+                                                          lifetime_scale,
+                                          }));
+    }
+}
+
+// Where `physics()` would have taken a particle after `t` seconds, drag and the fall speed cap included
+static Vector2 cosmetic_particle_position(const CosmeticParticle *p, float t) {
+    const float x = p->origin.x + p->velocity.x * (1 - expf(-DRAG * t)) / DRAG;
+
+    const float capped_after = (MAX_FALL_SPEED - p->velocity.y) / G;
+    float y;
+    if (t < capped_after) {
+        y = p->origin.y + p->velocity.y * t + 0.5f * G * t * t;
+    } else {
+        y = p->origin.y + p->velocity.y * capped_after + 0.5f * G * capped_after * capped_after +
+            MAX_FALL_SPEED * (t - capped_after);
+    }
+    return (Vector2){x, y};
+}
+
+// Where a cosmetic particle is and what it looks like at `now`, false once it has expired
+static bool cosmetic_particle_at(const CosmeticParticle *p, const Stage *stage, double now, Rectangle *rect,
+                                 Color *color) {
+    const float age = now - p->spawned_at;
+    if (age > p->lifetime) {
+        return false;
+    }
+    Vector2 pos = cosmetic_particle_position(p, age);
+    // Land on the first surface below where it was spawned
+    const float floor = stage_floor_below(stage, pos.x + PARTICLE_SIZE / 2.0f, p->origin.y + PARTICLE_SIZE);
+    if (pos.y + PARTICLE_SIZE > floor) {
+        pos.y = floor - PARTICLE_SIZE;
+    }
+    *rect = (Rectangle){pos.x, pos.y, PARTICLE_SIZE, PARTICLE_SIZE};
+    *color = ColorAlpha(p->color, (p->lifetime - age) / fminf(p->lifetime, PARTICLE_LIFETIME));
+    return true;
+}
+
+void particles_draw(const Particles *particles, const Stage *stage, RectBatch *batch) {
+    const double now = world_time();
+    for (ptrdiff_t i = 0; i < stbds_arrlen(particles->cosmetic); i++) {
+        Rectangle rect;
+        Color color;
+        if (cosmetic_particle_at(&particles->cosmetic[i], stage, now, &rect, &color)) {
+            rect_batch_push(batch, rect, color);
         }
     }
 }
-void particles_update(Particles *particles, const Stage *stage, float dt) {
-    const ptrdiff_t len = stbds_arrlen(*particles);
-    if (len > 300) {
-        STB_DS_ARRAY_CLEAN((*particles), !(*particles)[i].active);
+
+void particles_free(Particles *particles) {
+    stbds_arrfree(particles->cosmetic);
+}
+
+ParticleLayer particle_layer_new(int width, int height) {
+    ParticleLayer layer = {0};
+    layer.image = GenImageColor(width / PARTICLE_LAYER_PIXEL_SIZE, height / PARTICLE_LAYER_PIXEL_SIZE, BLANK);
+    layer.texture = LoadTextureFromImage(layer.image);
+    SetTextureFilter(layer.texture, TEXTURE_FILTER_POINT);
+    return layer;
+}
+
+// Projects `rect` into layer pixels and queues it, anything outside of the layer is dropped
+static void particle_layer_push(ParticleLayer *layer, Rectangle rect, Color color) {
+    const float sx = layer->image.width / layer->view.width;
+    const float sy = layer->image.height / layer->view.height;
+    ParticleSplat splat = {
+        .x0 = roundf((rect.x - layer->view.x) * sx),
+        .y0 = roundf((rect.y - layer->view.y) * sy),
+        .x1 = roundf((rect.x + rect.width - layer->view.x) * sx),
+        .y1 = roundf((rect.y + rect.height - layer->view.y) * sy),
+        .color = {color.r * color.a / 255, color.g * color.a / 255, color.b * color.a / 255, color.a},
+    };
+    // Tiny particles still cover a pixel, like the rectangle rasterizer would do after pixelization
+    splat.x1 = splat.x1 > splat.x0 ? splat.x1 : splat.x0 + 1;
+    splat.y1 = splat.y1 > splat.y0 ? splat.y1 : splat.y0 + 1;
+
+    splat.x0 = splat.x0 < 0 ? 0 : splat.x0;
+    splat.y0 = splat.y0 < 0 ? 0 : splat.y0;
+    splat.x1 = splat.x1 > layer->image.width ? layer->image.width : splat.x1;
+    splat.y1 = splat.y1 > layer->image.height ? layer->image.height : splat.y1;
+    if (splat.x0 >= splat.x1 || splat.y0 >= splat.y1 || color.a == 0 || layer->splat_count == layer->splat_capacity) {
+        return;
     }
-    for (ptrdiff_t i = 0; i < stbds_arrlen(*particles); i++) {
-        Particle *p = &(*particles)[i];
-        if (!p->active) {
+    layer->splats[layer->splat_count++] = splat;
+}
+
+// Clears and rasterizes one band of rows, bands never share pixels so they can run in parallel. Splats are
+// blended in the order they were queued, same as the draw calls would have been
+static void particle_layer_splat_band(void *user_data, size_t band) {
+    ParticleLayer *layer = user_data;
+    Color *pixels = layer->image.data;
+    const int width = layer->image.width;
+    const int band_y0 = band * PARTICLE_LAYER_BAND_HEIGHT;
+    const int band_y1 = band_y0 + PARTICLE_LAYER_BAND_HEIGHT < layer->image.height
+                            ? band_y0 + PARTICLE_LAYER_BAND_HEIGHT
+                            : layer->image.height;
+    memset(&pixels[band_y0 * width], 0, (size_t)(band_y1 - band_y0) * width * sizeof(Color));
+
+    for (size_t i = 0; i < layer->splat_count; i++) {
+        const ParticleSplat *s = &layer->splats[i];
+        if (s->y1 <= band_y0 || s->y0 >= band_y1) {
             continue;
         }
-        physics(&p->physics, dt);
-        collision(&p->transform, &p->physics, stage, dt);
-        if (time_delta(p->created_at) > PARTICLE_LIFETIME) {
-            p->active = false;
+        const int y0 = s->y0 > band_y0 ? s->y0 : band_y0;
+        const int y1 = s->y1 < band_y1 ? s->y1 : band_y1;
+        const int inverse = 255 - s->color.a;
+        for (int y = y0; y < y1; y++) {
+            Color *row = &pixels[y * width];
+            for (int x = s->x0; x < s->x1; x++) {
+                Color *d = &row[x];
+                d->r = s->color.r + (d->r * inverse + 127) / 255;
+                d->g = s->color.g + (d->g * inverse + 127) / 255;
+                d->b = s->color.b + (d->b * inverse + 127) / 255;
+                d->a = s->color.a + (d->a * inverse + 127) / 255;
+            }
         }
     }
 }
+
+void particles_splat(const Particles *particles, const Stage *stage, Rectangle view, ParticleLayer *layer,
+                     JobPool *jobs, Arena *scratch) {
+    const double now = world_time();
+    layer->view = view;
+    // At most one splat per particle
+    layer->splat_capacity = stbds_arrlen(particles->cosmetic);
+    layer->splats = arena_array(scratch, ParticleSplat, layer->splat_capacity);
+    layer->splat_count = 0;
+    if (layer->splats == NULL) {
+        layer->splat_capacity = 0;
+    }
+    for (ptrdiff_t i = 0; i < stbds_arrlen(particles->cosmetic); i++) {
+        Rectangle rect;
+        Color color;
+        if (cosmetic_particle_at(&particles->cosmetic[i], stage, now, &rect, &color)) {
+            particle_layer_push(layer, rect, color);
+        }
+    }
+
+    const size_t bands = (layer->image.height + PARTICLE_LAYER_BAND_HEIGHT - 1) / PARTICLE_LAYER_BAND_HEIGHT;
+    job_pool_run(jobs, bands, particle_layer_splat_band, layer);
+    UpdateTexture(layer->texture, layer->image.data);
+}
+
+void particle_layer_draw(const ParticleLayer *layer) {
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    DrawTexturePro(layer->texture, (Rectangle){0, 0, layer->texture.width, layer->texture.height}, layer->view,
+                   Vector2Zero(), 0, WHITE);
+    EndBlendMode();
+}
+
+void particle_layer_free(ParticleLayer *layer) {
+    UnloadTexture(layer->texture);
+    UnloadImage(layer->image);
+}
@@ -1,25 +1,89 @@
 #ifndef PARTICLES_H
 #define PARTICLES_H
 
+#include "arena.h"
 #include "ecs.h"
+#include "job_pool.h"
 #include "raylib.h"
+#include "rng.h"
 
 #define PARTICLE_LIFETIME 2.0
 #define PARTICLE_VELOCITY 500
+#define PARTICLE_SIZE 8
 
+// Never more particles alive than this, spawns start getting cut at the soft limit
+#define PARTICLE_HARD_MAX 2000
+#define PARTICLE_SOFT_MAX 1000
+// Frame time the budget tries to stay under, anything slower scales spawns down
+#define PARTICLE_TARGET_FRAME_TIME (1.0 / 60.0)
+#define PARTICLE_MIN_SCALE 0.1f
+#define PARTICLE_RNG_SEED 0x5eed
+
+// A particle that only has to look plausible. It is never updated, where it is gets worked out from how it was
+// spawned when it is drawn
+typedef struct {
+    Vector2 origin;
+    Vector2 velocity;
+    Color color;
+    double spawned_at; // On the world clock
+    float lifetime;
+} CosmeticParticle;
+
+// Scales particle spawns down when frames get slow or there are already a lot of particles around
+typedef struct {
+    float frame_time; // Smoothed
+    float scale;      // Applied to spawn counts and lifetimes
+    Rectangle view;   // What the camera sees, spawns far outside of it are dropped first
+
+    // Counters for the overlay and benchmarks
+    size_t live;
+    size_t requested;
+    size_t spawned;
+    size_t dropped;
+} ParticleBudget;
+
+typedef struct {
+    CosmeticParticle *cosmetic;
+    ParticleBudget budget;
+    Rng rng; // Apart from the gameplay one, how many particles spawn doesn't change what enemies do
+} Particles;
+
+// Pixelization works in 2x2 blocks, the splat layer has one pixel per block
+#define PARTICLE_LAYER_PIXEL_SIZE 2
+// Rows of the layer rasterized by a single job
+#define PARTICLE_LAYER_BAND_HEIGHT 32
+
+// A particle already projected into layer pixels, `color` is premultiplied
 typedef struct {
-    TransformComp transform;
-    PhysicsComp physics;
+    int x0, y0, x1, y1;
     Color color;
-    double created_at;
-    bool active;
-} Particle;
+} ParticleSplat;
 
-typedef Particle* Particles;
+// Particles rasterized on the CPU at the pixelized resolution, uploaded and drawn as a single quad
+typedef struct {
+    Image image;
+    Texture2D texture;
+    ParticleSplat *splats; // Scratch of the frame it was splatted in
+    size_t splat_count;
+    size_t splat_capacity;
+    Rectangle view; // The part of the world the layer covers
+} ParticleLayer;
 
-void particles_push(Particles* particles, Particle p);
+Particles particles_new();
+// Spawns up to `n` cosmetic particles, depending on what the budget allows
 void particles_spawn_n_in_dir(Particles *particles, int n, Color c, Vector2 dir, Vector2 pos);
-void particles_draw(const Particles *particles);
-void particles_update(Particles *particles, const Stage *stage, float dt);
+// Feeds the budget with the last frame time and the camera view, also retires expired particles
+void particles_budget_update(Particles *particles, float frame_time, Rectangle view);
+void particles_draw(const Particles *particles, const Stage *stage, RectBatch *batch);
+void particles_free(Particles *particles);
+
+// `width` and `height` are the size of the screen the layer gets drawn over
+ParticleLayer particle_layer_new(int width, int height);
+// Splats all live particles inside of `view` into the layer and uploads it, the splats are queued in `scratch`
+void particles_splat(const Particles *particles, const Stage *stage, Rectangle view, ParticleLayer *layer,
+                     JobPool *jobs, Arena *scratch);
+// Draws the layer over the view it was splatted for, has to be called inside of the camera's 2D mode
+void particle_layer_draw(const ParticleLayer *layer);
+void particle_layer_free(ParticleLayer *layer);
 
 #endif
@@ -8,14 +8,14 @@ void pickups_spawn(Pickups *pickups, Pickup p) {
     stbds_arrput(*pickups, p);
 }
 
-void pickups_draw(const Pickups *pickups) {
+void pickups_draw(const Pickups *pickups, RectBatch *batch) {
     for (ptrdiff_t i = 0; i < stbds_arrlen(*pickups); i++) {
         const Pickup *p = &(*pickups)[i];
         if (p->active) {
-            DrawRectangleRec(p->transform.rect, WHITE);
-        } else if (time_delta(p->picked_up_at) < PICKUP_FADE_OUT_TIME) {
-            const double t = time_delta(p->picked_up_at) * (1 / PICKUP_FADE_OUT_TIME);
-            DrawRectangleRec(p->transform.rect, GetColor(0xffffffff - (t * 255)));
+            rect_batch_push(batch, p->transform.rect, WHITE);
+        } else if (world_time_since(p->picked_up_at) < PICKUP_FADE_OUT_TIME) {
+            const double t = world_time_since(p->picked_up_at) * (1 / PICKUP_FADE_OUT_TIME);
+            rect_batch_push(batch, p->transform.rect, GetColor(0xffffffff - (t * 255)));
         }
     }
 }
@@ -26,7 +26,7 @@ void pickups_update(Pickups *pickups, const Stage *stage, float dt) {
             physics(&p->physics, dt);
             collision(&p->transform, &p->physics, stage, dt);
         } else {
-            if (time_delta(p->picked_up_at) > PICKUP_FADE_OUT_TIME) {
+            if (world_time_since(p->picked_up_at) > PICKUP_FADE_OUT_TIME) {
                 stbds_arrdel(*pickups, i);
             }
         }
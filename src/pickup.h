@@ -29,7 +29,7 @@ Pickup health_pickup(float x, float y, float w, float h, size_t health);
 Pickup coin_pickup(float x, float y, float w, float h, size_t coin);
 
 void pickups_spawn(Pickups *pickups, Pickup p); 
-void pickups_draw(const Pickups* pickups);
+void pickups_draw(const Pickups* pickups, RectBatch *batch);
 void pickups_update(Pickups *pickups, const Stage *stage, float dt);
 
 #endif
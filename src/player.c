@@ -2,8 +2,10 @@
 #include "bullet.h"
 #include "ecs.h"
 #include "enemy.h"
+#include "input.h"
 #include "particles.h"
 #include "pickup.h"
+#include "sounds.h"
 #include "static_config.h"
 #include "timing_utilities.h"
 #include "weapon.h"
@@ -23,28 +25,29 @@ ECSPlayer ecs_player_new() {
                                  .coins = 10},
                        .physics = DEFAULT_PHYSICS(),
                        .draw_conf = {.color = WHITE},
-                       .jump_sound = LoadSound("assets/sfx/player_jump.wav"),
+                       .jump_sound = SFX_PLAYER_JUMP,
                        .selected = 1,
                        .weapons = {create_pistol(), create_ar(), create_shotgun()},
                        .health = {10, 10}};
 }
 
-void ecs_player_update(ECSPlayer *player, const Stage *stage, const EnemyWave *wave, Bullets *bullets,
-                       Bullets *enemy_bullets, Pickups *pickups, const Camera2D *camera, Particles *particles) {
+bool ecs_player_update(ECSPlayer *player, const Stage *stage, const EnemyWave *wave, Bullets *bullets,
+                       Bullets *enemy_bullets, Pickups *pickups, const Camera2D *camera, Particles *particles,
+                       Rng *rng) {
     if (player->state.dead) {
-        return;
+        return false;
     }
-    float dt = GetFrameTime();
+    float dt = frame_time();
 
-    if (time_delta(player->state.last_hit) < INVULNERABILITY_TIME) {
+    if (world_time_since(player->state.last_hit) < INVULNERABILITY_TIME) {
         player->draw_conf.color = RED;
-    } else if (time_delta(player->state.last_healed) < INVULNERABILITY_TIME) {
+    } else if (world_time_since(player->state.last_healed) < INVULNERABILITY_TIME) {
         player->draw_conf.color = GetColor(0x55dd55ff);
     } else {
         player->draw_conf.color = WHITE;
     }
 
-    player_input(player, bullets, camera, particles);
+    const bool pressed = player_input(player, bullets, camera, particles, rng);
     physics(&player->physics, dt);
     collision(&player->transform, &player->physics, stage, dt);
     player_enemy_interaction(player, wave, enemy_bullets, particles);
@@ -52,6 +55,7 @@ void ecs_player_update(ECSPlayer *player, const Stage *stage, const EnemyWave *w
     if (player->health.current <= 0) {
         player->state.dead = true;
     }
+    return pressed;
 }
 
 void player_enemy_interaction(ECSPlayer *player, const EnemyWave *wave, Bullets *enemy_bullets, Particles *particles) {
@@ -62,8 +66,8 @@ void player_enemy_interaction(ECSPlayer *player, const EnemyWave *wave, Bullets
             continue;
         }
         if (CheckCollisionRecs(player->transform.rect, (*wave)[i].transform.rect) &&
-            time_delta(player->state.last_hit) > INVULNERABILITY_TIME) {
-            player->state.last_hit = GetTime();
+            world_time_since(player->state.last_hit) > INVULNERABILITY_TIME) {
+            player->state.last_hit = world_time();
             player->health.current--;
 
             const Vector2 player_center = transform_center(&player->transform);
@@ -89,8 +93,8 @@ void player_enemy_interaction(ECSPlayer *player, const EnemyWave *wave, Bullets
             continue;
         }
         if (CheckCollisionRecs(player->transform.rect, b->transform.rect) &&
-            time_delta(player->state.last_hit) > INVULNERABILITY_TIME) {
-            player->state.last_hit = GetTime();
+            world_time_since(player->state.last_hit) > INVULNERABILITY_TIME) {
+            player->state.last_hit = world_time();
             player->health.current--;
             Vector2 dir = Vector2Rotate(b->direction, PI);
             dir.y *= 2;
@@ -101,42 +105,48 @@ void player_enemy_interaction(ECSPlayer *player, const EnemyWave *wave, Bullets
     }
 }
 
-void player_input(ECSPlayer *player, Bullets *bullets, const Camera2D *camera, Particles *particles) {
-    if (time_delta(player->state.last_shot) > SHOOT_DELAY - player->state.reload_time) {
-        if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-            player->weapons[player->selected].try_shoot(&player->weapons[player->selected], bullets, &player->transform,
-                                                        camera);
+bool player_input(ECSPlayer *player, Bullets *bullets, const Camera2D *camera, Particles *particles, Rng *rng) {
+    // Only edges count, held keys aren't new input
+    bool pressed = input_button_pressed(MOUSE_BUTTON_LEFT) || input_key_pressed(KEY_A) || input_key_pressed(KEY_D);
+    if (world_time_since(player->state.last_shot) > SHOOT_DELAY - player->state.reload_time) {
+        if (input_button_down(MOUSE_BUTTON_LEFT)) {
+            weapon_try_shoot(&player->weapons[player->selected], bullets, &player->transform, camera, rng);
         }
     }
 
-    if (IsKeyDown(KEY_A)) {
+    if (input_key_down(KEY_A)) {
         player->physics.velocity.x = -500;
     }
-    if (IsKeyDown(KEY_D)) {
+    if (input_key_down(KEY_D)) {
         player->physics.velocity.x = 500;
     }
-    if (IsKeyPressed(KEY_Z)) {
+    if (input_key_pressed(KEY_Z)) {
         player->selected = WT_PISTOL;
+        pressed = true;
     }
-    if (IsKeyPressed(KEY_X)) {
+    if (input_key_pressed(KEY_X)) {
         player->selected = WT_AR;
+        pressed = true;
     }
-    if (IsKeyPressed(KEY_C)) {
+    if (input_key_pressed(KEY_C)) {
         player->selected = WT_SHOTGUN;
+        pressed = true;
     }
 
-    if (player->physics.grounded && IsKeyPressed(KEY_SPACE)) {
+    if (player->physics.grounded && input_key_pressed(KEY_SPACE)) {
         player->physics.velocity.y = -player->state.jump_power;
-        PlaySound(player->jump_sound);
+        sound_play(player->jump_sound);
         player->physics.grounded = false;
         const Vector2 pos = transform_center(&player->transform);
         particles_spawn_n_in_dir(particles, 5, WHITE, (Vector2){0, 1}, pos);
+        pressed = true;
     }
+    return pressed;
 }
 
-void player_draw(const ECSPlayer *player) {
+void player_draw(const ECSPlayer *player, RectBatch *batch) {
     if (!player->state.dead) {
-        draw_solid(&player->transform, &player->draw_conf);
+        draw_solid(&player->transform, &player->draw_conf, batch);
     }
 }
 void player_pickup_interaction(ECSPlayer *player, Pickups *pickups) {
@@ -144,7 +154,7 @@ void player_pickup_interaction(ECSPlayer *player, Pickups *pickups) {
         Pickup *p = &(*pickups)[i];
         if (p->active) {
             if (CheckCollisionRecs(p->transform.rect, player->transform.rect)) {
-                const double T = GetTime();
+                const double T = world_time();
                 switch (p->type) {
                 case PT_HEALTH: {
                     player->health.current = Clamp(player->health.current + p->health, 0, player->health.max);
@@ -41,18 +41,19 @@ typedef struct {
     SolidRectangleComp draw_conf;
     size_t selected;
     Weapon weapons[WT_COUNT];
-    Sound jump_sound;
+    SoundId jump_sound;
 } ECSPlayer;
 
 
 ECSPlayer ecs_player_new();
-// Handles player input
-void player_input(ECSPlayer *player, Bullets *bullets,
-                  const Camera2D *camera, Particles *particles);
-// Updates the entire player state
-void ecs_player_update(ECSPlayer *player, const Stage *stage, const EnemyWave *wave, Bullets *bullets,
-                       Bullets *enemy_bullets, Pickups *pickups, const Camera2D* camera, Particles* particles);
+// Handles player input, true if a key or button was pressed this frame and acted on
+bool player_input(ECSPlayer *player, Bullets *bullets,
+                  const Camera2D *camera, Particles *particles, Rng *rng);
+// Updates the entire player state, true if `player_input` saw a press
+bool ecs_player_update(ECSPlayer *player, const Stage *stage, const EnemyWave *wave, Bullets *bullets,
+                       Bullets *enemy_bullets, Pickups *pickups, const Camera2D* camera, Particles* particles,
+                       Rng *rng);
 void player_enemy_interaction(ECSPlayer *player, const EnemyWave *wave, Bullets *enemy_bullets, Particles *particles);
 void player_pickup_interaction(ECSPlayer *player, Pickups* pickups);
-void player_draw(const ECSPlayer *player);
+void player_draw(const ECSPlayer *player, RectBatch *batch);
 #endif
@@ -0,0 +1,186 @@
+#include "render.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+RectBatch rect_batch_new(size_t capacity) {
+    RectBatch batch = {.capacity = capacity < RECT_BATCH_CAPACITY ? capacity : RECT_BATCH_CAPACITY};
+    batch.positions = calloc(batch.capacity * 4, sizeof(Vector2));
+    batch.colors = calloc(batch.capacity * 4, sizeof(Color));
+
+    // Quads never change their topology, only the vertices get uploaded every flush
+    // Same winding as raylib's own quads so backface culling treats them alike
+    uint16_t *indices = malloc(batch.capacity * 6 * sizeof(uint16_t));
+    for (size_t i = 0; i < batch.capacity; i++) {
+        indices[i * 6 + 0] = i * 4 + 0;
+        indices[i * 6 + 1] = i * 4 + 1;
+        indices[i * 6 + 2] = i * 4 + 2;
+        indices[i * 6 + 3] = i * 4 + 0;
+        indices[i * 6 + 4] = i * 4 + 2;
+        indices[i * 6 + 5] = i * 4 + 3;
+    }
+
+    batch.vao = rlLoadVertexArray();
+    rlEnableVertexArray(batch.vao);
+    batch.position_vbo = rlLoadVertexBuffer(batch.positions, batch.capacity * 4 * sizeof(Vector2), true);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 2, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+    batch.color_vbo = rlLoadVertexBuffer(batch.colors, batch.capacity * 4 * sizeof(Color), true);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, true, 0, 0);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+    batch.ebo = rlLoadVertexBufferElement(indices, batch.capacity * 6 * sizeof(uint16_t), false);
+    rlDisableVertexArray();
+
+    free(indices);
+    return batch;
+}
+
+static void rect_batch_push_corners(RectBatch *batch, Vector2 top_left, Vector2 bottom_left, Vector2 bottom_right,
+                                    Vector2 top_right, Color color) {
+    if (batch->count == batch->capacity) {
+        rect_batch_flush(batch);
+    }
+    Vector2 *p = &batch->positions[batch->count * 4];
+    Color *c = &batch->colors[batch->count * 4];
+    p[0] = top_left;
+    p[1] = bottom_left;
+    p[2] = bottom_right;
+    p[3] = top_right;
+    c[0] = c[1] = c[2] = c[3] = color;
+    batch->count++;
+}
+
+void rect_batch_begin(RectBatch *batch, Rectangle view) {
+    batch->view = view;
+    batch->stats = (RectBatchStats){0};
+}
+
+bool rect_batch_visible(RectBatch *batch, Rectangle bounds) {
+    if (batch->view.width <= 0 || CheckCollisionRecs(bounds, batch->view)) {
+        return true;
+    }
+    batch->stats.culled++;
+    return false;
+}
+
+void rect_batch_push(RectBatch *batch, Rectangle rect, Color color) {
+    if (!rect_batch_visible(batch, rect)) {
+        return;
+    }
+    rect_batch_push_corners(batch, (Vector2){rect.x, rect.y}, (Vector2){rect.x, rect.y + rect.height},
+                            (Vector2){rect.x + rect.width, rect.y + rect.height}, (Vector2){rect.x + rect.width, rect.y},
+                            color);
+}
+
+void rect_batch_push_rotated(RectBatch *batch, Rectangle rect, Vector2 origin, Vector2 rotation, Color color) {
+    // No corner is further from the pivot than this, whatever the rotation
+    const float radius =
+        Vector2Length((Vector2){fmaxf(origin.x, rect.width - origin.x), fmaxf(origin.y, rect.height - origin.y)});
+    if (!rect_batch_visible(batch, (Rectangle){rect.x - radius, rect.y - radius, radius * 2, radius * 2})) {
+        return;
+    }
+    const float dx = -origin.x;
+    const float dy = -origin.y;
+    const float c = rotation.x;
+    const float s = rotation.y;
+    // Corners relative to the pivot at (rect.x, rect.y), rotated around it
+#define CORNER(x_, y_) (Vector2){rect.x + (x_) * c - (y_) * s, rect.y + (x_) * s + (y_) * c}
+    rect_batch_push_corners(batch, CORNER(dx, dy), CORNER(dx, dy + rect.height),
+                            CORNER(dx + rect.width, dy + rect.height), CORNER(dx + rect.width, dy), color);
+#undef CORNER
+}
+
+void rect_batch_flush(RectBatch *batch) {
+    rect_batch_upload(batch);
+    rect_batch_draw(batch);
+    batch->count = 0;
+}
+
+void rect_batch_upload(RectBatch *batch) {
+    if (batch->count == 0) {
+        return;
+    }
+    rlUpdateVertexBuffer(batch->position_vbo, batch->positions, batch->count * 4 * sizeof(Vector2), 0);
+    rlUpdateVertexBuffer(batch->color_vbo, batch->colors, batch->count * 4 * sizeof(Color), 0);
+}
+
+void rect_batch_draw(RectBatch *batch) {
+    if (batch->count == 0) {
+        return;
+    }
+    // Whatever raylib batched up so far goes first
+    rlDrawRenderBatchActive();
+
+    const int *locs = rlGetShaderLocsDefault();
+    rlEnableShader(rlGetShaderIdDefault());
+    rlSetUniformMatrix(locs[RL_SHADER_LOC_MATRIX_MVP], MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+    const float white[4] = {1, 1, 1, 1};
+    rlSetUniform(locs[RL_SHADER_LOC_COLOR_DIFFUSE], white, RL_SHADER_UNIFORM_VEC4, 1);
+    rlActiveTextureSlot(0);
+    rlEnableTexture(rlGetTextureIdDefault());
+
+    rlEnableVertexArray(batch->vao);
+    rlDrawVertexArrayElements(0, batch->count * 6, NULL);
+    rlDisableVertexArray();
+    rlDisableTexture();
+    rlDisableShader();
+
+    batch->stats.quads += batch->count;
+    batch->stats.draws++;
+}
+
+void rect_batch_free(RectBatch *batch) {
+    rlUnloadVertexArray(batch->vao);
+    rlUnloadVertexBuffer(batch->position_vbo);
+    rlUnloadVertexBuffer(batch->color_vbo);
+    rlUnloadVertexBuffer(batch->ebo);
+    free(batch->positions);
+    free(batch->colors);
+}
+
+RenderGraph render_graph_new() {
+    return (RenderGraph){
+        .passes =
+            {
+                [RP_PLAYFIELD] = {.name = "playfield"},
+                [RP_UI] = {.name = "ui"},
+                [RP_COMPOSITE] = {.name = "composite",
+                                  .reads = 1 << RP_PLAYFIELD | 1 << RP_UI,
+                                  .output = true,
+                                  .enabled = true},
+            },
+    };
+}
+
+void render_graph_cull(RenderGraph *graph) {
+    uint32_t needed = 0;
+    graph->live = 0;
+    graph->culled = 0;
+    for (int i = RP_COUNT - 1; i >= 0; i--) {
+        RenderPass *pass = &graph->passes[i];
+        pass->live = pass->enabled && (pass->output || (needed & (1u << i)));
+        if (pass->live) {
+            needed |= pass->reads;
+            graph->live++;
+        } else {
+            graph->culled++;
+        }
+    }
+}
+
+CompositeShader composite_shader_load() {
+    CompositeShader composite = {.shader = LoadShader(NULL, "assets/shaders/composite.fs")};
+    composite.ui_texture_loc = GetShaderLocation(composite.shader, "uiTexture");
+    composite.screen_size_loc = GetShaderLocation(composite.shader, "screenSize");
+    composite.pixel_size_loc = GetShaderLocation(composite.shader, "pixelSize");
+    composite.playfield_enabled_loc = GetShaderLocation(composite.shader, "playfieldEnabled");
+    composite.ui_enabled_loc = GetShaderLocation(composite.shader, "uiEnabled");
+    composite.background_loc = GetShaderLocation(composite.shader, "background");
+    return composite;
+}
+
+void composite_shader_unload(CompositeShader *composite) {
+    UnloadShader(composite->shader);
+}
@@ -0,0 +1,95 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Quads per draw, indices are 16 bit so a batch can't address more than 65536 vertices
+#define RECT_BATCH_CAPACITY 16384
+
+// Per frame counters for the overlay
+typedef struct {
+    size_t quads;
+    size_t draws;
+    size_t culled; // Quads or whole objects left out because they were outside of the view
+} RectBatchStats;
+
+// Solid colored quads collected into a preallocated vertex array and submitted with a single draw
+// Things drawn through raylib in between have to be preceded by `rect_batch_flush` to keep the order
+typedef struct {
+    Vector2 *positions; // 4 per quad
+    Color *colors;      // 4 per quad
+    size_t count;
+    size_t capacity;
+
+    unsigned int vao;
+    unsigned int position_vbo;
+    unsigned int color_vbo;
+    unsigned int ebo;
+
+    Rectangle view; // Anything outside of it is culled, an empty view disables culling
+    RectBatchStats stats;
+} RectBatch;
+
+// Has to be called after the window is created, `capacity` is at most `RECT_BATCH_CAPACITY`
+RectBatch rect_batch_new(size_t capacity);
+// Starts a frame for the camera looking at `view` and resets the counters
+void rect_batch_begin(RectBatch *batch, Rectangle view);
+// Whether something covering `bounds` would be seen, counts it as culled if not. Lets draw functions skip whole
+// objects made of several quads with a single test
+bool rect_batch_visible(RectBatch *batch, Rectangle bounds);
+void rect_batch_push(RectBatch *batch, Rectangle rect, Color color);
+// Same as `DrawRectanglePro` but takes the rotation as (cos, sin) so it doesn't have to be worked out per frame
+void rect_batch_push_rotated(RectBatch *batch, Rectangle rect, Vector2 origin, Vector2 rotation, Color color);
+// Draws everything pushed so far with the current matrices and blend mode, then empties the batch
+void rect_batch_flush(RectBatch *batch);
+
+// For geometry that rarely changes: upload it once, then draw it as often as needed without touching it again
+void rect_batch_upload(RectBatch *batch);
+void rect_batch_draw(RectBatch *batch);
+void rect_batch_free(RectBatch *batch);
+
+typedef enum {
+    RP_PLAYFIELD = 0,
+    RP_UI,
+    RP_COMPOSITE,
+    RP_COUNT,
+} RenderPassId;
+
+typedef struct {
+    const char *name;
+    uint32_t reads; // Passes whose output this one samples, bit i is pass i
+    bool output;    // Ends up on the screen, always kept unless disabled
+    bool enabled;   // Set every frame, false when the pass is turned off or has nothing to draw
+    bool live;      // Set by `render_graph_cull`
+} RenderPass;
+
+// The passes a frame is made of and what they depend on, so that the ones nobody needs are skipped
+typedef struct {
+    RenderPass passes[RP_COUNT];
+    size_t live;
+    size_t culled;
+} RenderGraph;
+
+RenderGraph render_graph_new();
+// Keeps enabled passes that are either an output or read by another kept pass, passes are declared in
+// dependency order
+void render_graph_cull(RenderGraph *graph);
+
+// The fused final pass, see assets/shaders/composite.fs. Uniform locations are looked up once on load
+typedef struct {
+    Shader shader;
+    int ui_texture_loc;
+    int screen_size_loc;
+    int pixel_size_loc;
+    int playfield_enabled_loc;
+    int ui_enabled_loc;
+    int background_loc;
+} CompositeShader;
+
+CompositeShader composite_shader_load();
+void composite_shader_unload(CompositeShader *composite);
+
+#endif
@@ -0,0 +1,23 @@
+#include "rng.h"
+
+Rng rng_new(uint64_t seed) {
+    return (Rng){.state = seed};
+}
+
+// splitmix64
+uint64_t rng_next(Rng *rng) {
+    uint64_t z = (rng->state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+int rng_range(Rng *rng, int min, int max) {
+    if (min > max) {
+        const int tmp = min;
+        min = max;
+        max = tmp;
+    }
+    const uint64_t span = (uint64_t)((int64_t)max - min) + 1;
+    return min + (int64_t)(rng_next(rng) % span);
+}
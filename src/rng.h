@@ -0,0 +1,17 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Random numbers whose whole state is one word, so a copy of the world carries on exactly where it left off.
+// raylib's `GetRandomValue` has a hidden global state and isn't safe to call from several threads
+typedef struct {
+    uint64_t state;
+} Rng;
+
+Rng rng_new(uint64_t seed);
+uint64_t rng_next(Rng *rng);
+// In `[min, max]`, same as `GetRandomValue`
+int rng_range(Rng *rng, int min, int max);
+
+#endif
@@ -0,0 +1,209 @@
+#include "save.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t chunk_count;
+    uint32_t reserved;
+} SaveHeader;
+
+typedef struct {
+    char id[4];
+    uint32_t element_size;
+    uint64_t count;
+} SaveChunk;
+
+_Static_assert(sizeof(SaveHeader) % SAVE_ALIGNMENT == 0, "chunks have to stay aligned");
+_Static_assert(sizeof(SaveChunk) % SAVE_ALIGNMENT == 0, "chunk contents have to stay aligned");
+
+// What goes into a chunk, `data` is either read from or written to
+typedef struct {
+    const char *id;
+    size_t element_size;
+    const void **data;
+    size_t *count;
+} SaveChunkView;
+
+#define SAVE_CHUNK_COUNT 6
+
+static bool host_is_little_endian() {
+    const uint16_t one = 1;
+    return *(const uint8_t *)&one == 1;
+}
+
+static size_t save_align(size_t size) {
+    return (size + SAVE_ALIGNMENT - 1) & ~(size_t)(SAVE_ALIGNMENT - 1);
+}
+
+// The single elements are chunks of one
+static void save_chunks(SaveGame *game, SaveChunkView chunks[SAVE_CHUNK_COUNT], const void *singles[2],
+                        size_t ones[2]) {
+    singles[0] = &game->progress;
+    singles[1] = &game->player;
+    ones[0] = 1;
+    ones[1] = 1;
+    chunks[0] = (SaveChunkView){"PROG", sizeof(SaveProgress), &singles[0], &ones[0]};
+    chunks[1] = (SaveChunkView){"PLYR", sizeof(ECSPlayer), &singles[1], &ones[1]};
+    chunks[2] = (SaveChunkView){"WAVE", sizeof(ECSEnemy), (const void **)&game->wave, &game->wave_count};
+    chunks[3] = (SaveChunkView){"BULL", sizeof(Bullet), (const void **)&game->bullets, &game->bullet_count};
+    chunks[4] = (SaveChunkView){"EBUL", sizeof(Bullet), (const void **)&game->enemy_bullets,
+                                &game->enemy_bullet_count};
+    chunks[5] = (SaveChunkView){"PICK", sizeof(Pickup), (const void **)&game->pickups, &game->pickup_count};
+}
+
+SaveResult save_write(const char *path, const SaveGame *game) {
+    if (!host_is_little_endian()) {
+        return SAVE_ERROR_FORMAT;
+    }
+    SaveGame copy = *game;
+    SaveChunkView chunks[SAVE_CHUNK_COUNT];
+    const void *singles[2];
+    size_t ones[2];
+    save_chunks(&copy, chunks, singles, ones);
+
+    size_t size = sizeof(SaveHeader);
+    for (int i = 0; i < SAVE_CHUNK_COUNT; i++) {
+        size += sizeof(SaveChunk) + save_align(chunks[i].element_size * *chunks[i].count);
+    }
+    // malloc aligns to at least `SAVE_ALIGNMENT`
+    uint8_t *data = calloc(1, size);
+    if (data == NULL) {
+        return SAVE_ERROR_MEMORY;
+    }
+
+    SaveHeader *header = (SaveHeader *)data;
+    memcpy(header->magic, SAVE_MAGIC, sizeof(header->magic));
+    header->version = SAVE_VERSION;
+    header->chunk_count = SAVE_CHUNK_COUNT;
+    size_t cursor = sizeof(SaveHeader);
+    for (int i = 0; i < SAVE_CHUNK_COUNT; i++) {
+        SaveChunk *chunk = (SaveChunk *)(data + cursor);
+        memcpy(chunk->id, chunks[i].id, sizeof(chunk->id));
+        chunk->element_size = chunks[i].element_size;
+        chunk->count = *chunks[i].count;
+        cursor += sizeof(SaveChunk);
+        const size_t bytes = chunks[i].element_size * *chunks[i].count;
+        if (bytes > 0) {
+            memcpy(data + cursor, *chunks[i].data, bytes);
+        }
+        cursor += save_align(bytes);
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        free(data);
+        return SAVE_ERROR_IO;
+    }
+    const bool written = fwrite(data, 1, size, file) == size;
+    free(data);
+    return fclose(file) == 0 && written ? SAVE_OK : SAVE_ERROR_IO;
+}
+
+// Checks the file in `data` and points `game` into it
+static SaveResult save_parse(const uint8_t *data, size_t size, SaveGame *game) {
+    const SaveHeader *header = (const SaveHeader *)data;
+    if (memcmp(header->magic, SAVE_MAGIC, sizeof(header->magic)) != 0) {
+        return SAVE_ERROR_FORMAT;
+    }
+    if (header->version != SAVE_VERSION) {
+        return SAVE_ERROR_VERSION;
+    }
+
+    SaveGame loaded = {0};
+    SaveChunkView chunks[SAVE_CHUNK_COUNT];
+    const void *singles[2];
+    size_t ones[2];
+    save_chunks(&loaded, chunks, singles, ones);
+    // Set again by the chunks that are there
+    ones[0] = 0;
+    ones[1] = 0;
+
+    size_t cursor = sizeof(SaveHeader);
+    for (uint32_t i = 0; i < header->chunk_count; i++) {
+        if (size - cursor < sizeof(SaveChunk)) {
+            return SAVE_ERROR_FORMAT;
+        }
+        const SaveChunk *chunk = (const SaveChunk *)(data + cursor);
+        cursor += sizeof(SaveChunk);
+        if (chunk->element_size != 0 && chunk->count > (size - cursor) / chunk->element_size) {
+            return SAVE_ERROR_FORMAT;
+        }
+        const size_t bytes = chunk->element_size * chunk->count;
+        for (int j = 0; j < SAVE_CHUNK_COUNT; j++) {
+            if (memcmp(chunk->id, chunks[j].id, sizeof(chunk->id)) != 0) {
+                continue;
+            }
+            if (chunk->element_size != chunks[j].element_size) {
+                return SAVE_ERROR_VERSION;
+            }
+            *chunks[j].data = data + cursor;
+            *chunks[j].count = chunk->count;
+        }
+        // The padding of the last chunk may be missing
+        cursor = save_align(cursor + bytes) < size ? save_align(cursor + bytes) : size;
+    }
+    if (ones[0] != 1 || ones[1] != 1) {
+        return SAVE_ERROR_FORMAT;
+    }
+    loaded.progress = *(const SaveProgress *)singles[0];
+    loaded.player = *(const ECSPlayer *)singles[1];
+    *game = loaded;
+    return SAVE_OK;
+}
+
+SaveResult save_read(const char *path, SaveGame *game) {
+    if (!host_is_little_endian()) {
+        return SAVE_ERROR_FORMAT;
+    }
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return SAVE_ERROR_IO;
+    }
+    fseek(file, 0, SEEK_END);
+    const long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (file_size < (long)sizeof(SaveHeader)) {
+        fclose(file);
+        return SAVE_ERROR_FORMAT;
+    }
+    const size_t size = file_size;
+    // malloc aligns to at least `SAVE_ALIGNMENT`, the chunks are used in place
+    uint8_t *data = malloc(size);
+    if (data == NULL) {
+        fclose(file);
+        return SAVE_ERROR_MEMORY;
+    }
+    const bool read = fread(data, 1, size, file) == size;
+    fclose(file);
+    const SaveResult result = read ? save_parse(data, size, game) : SAVE_ERROR_IO;
+    if (result != SAVE_OK) {
+        free(data);
+        return result;
+    }
+    game->data = data;
+    return SAVE_OK;
+}
+
+void save_game_free(SaveGame *game) {
+    free(game->data);
+    game->data = NULL;
+}
+
+const char *save_result_message(SaveResult result) {
+    switch (result) {
+    case SAVE_OK:
+        return "Saved";
+    case SAVE_ERROR_IO:
+        return "Save file couldn't be accessed";
+    case SAVE_ERROR_FORMAT:
+        return "Save file is damaged";
+    case SAVE_ERROR_VERSION:
+        return "Save file is from another version";
+    case SAVE_ERROR_MEMORY:
+        return "Not enough memory for the save file";
+    }
+    return "?";
+}
@@ -0,0 +1,66 @@
+#ifndef SAVE_H
+#define SAVE_H
+
+#include "bullet.h"
+#include "enemy.h"
+#include "pickup.h"
+#include "player.h"
+#include "rng.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Save files are a header and a list of chunks, all little-endian:
+//
+//   header  "PSAV", u32 version, u32 chunk count, u32 reserved
+//   chunk   4 byte id, u32 element size, u64 element count, then the elements padded to 8 bytes
+//
+// Elements are the entity structs as they are in memory, which works since they hold no pointers. Chunks are 8
+// byte aligned, so a loaded file is used in place without parsing anything. Unknown chunks are skipped, missing
+// ones are empty. `SAVE_VERSION` goes up whenever a struct that ends up in a chunk changes its layout
+// Entity timestamps are on the world clock, which is saved along with them and put back on load
+#define SAVE_MAGIC "PSAV"
+#define SAVE_VERSION 2
+#define SAVE_ALIGNMENT 8
+
+typedef enum {
+    SAVE_OK,
+    SAVE_ERROR_IO,
+    SAVE_ERROR_FORMAT,  // Not a save or cut short
+    SAVE_ERROR_VERSION, // Written by another version of the game
+    SAVE_ERROR_MEMORY,  // No memory for the file
+} SaveResult;
+
+// Game progress that isn't an entity
+typedef struct {
+    uint64_t wave_number;
+    double wave_strength;
+    uint64_t selected_stage;
+    double speed_cost;
+    Rng rng;
+    double clock; // What the entity timestamps are relative to
+} SaveProgress;
+
+// What a save holds. After `save_read` the arrays point into `data`, the file as it was read
+typedef struct {
+    SaveProgress progress;
+    ECSPlayer player;
+    const ECSEnemy *wave;
+    size_t wave_count;
+    const Bullet *bullets;
+    size_t bullet_count;
+    const Bullet *enemy_bullets;
+    size_t enemy_bullet_count;
+    const Pickup *pickups;
+    size_t pickup_count;
+    void *data;
+} SaveGame;
+
+// The file is put together in a buffer sized for it and written in one go
+SaveResult save_write(const char *path, const SaveGame *game);
+// Has to be followed by `save_game_free` when it succeeds
+SaveResult save_read(const char *path, SaveGame *game);
+void save_game_free(SaveGame *game);
+const char *save_result_message(SaveResult result);
+
+#endif
@@ -0,0 +1,76 @@
+#include "schedule.h"
+#include <assert.h>
+
+Schedule schedule_new() {
+    return (Schedule){0};
+}
+
+void schedule_add(Schedule *schedule, const char *name, SystemFn run, uint32_t reads, uint32_t writes) {
+    assert(schedule->count < SCHEDULE_MAX_SYSTEMS);
+    schedule->systems[schedule->count++] = (System){.name = name, .run = run, .reads = reads, .writes = writes};
+    schedule->built = false;
+}
+
+static bool systems_conflict(const System *a, const System *b) {
+    return (a->writes & (b->reads | b->writes)) || (b->writes & a->reads);
+}
+
+void schedule_build(Schedule *schedule) {
+    schedule->level_count = 0;
+    for (size_t i = 0; i < schedule->count; i++) {
+        System *system = &schedule->systems[i];
+        system->after = 0;
+        system->level = 0;
+        for (size_t j = 0; j < i; j++) {
+            if (systems_conflict(system, &schedule->systems[j])) {
+                system->after |= 1u << j;
+                // Earlier systems already have their level, one past the deepest one it waits for
+                if (schedule->systems[j].level + 1 > system->level) {
+                    system->level = schedule->systems[j].level + 1;
+                }
+            }
+        }
+        if (system->level + 1 > schedule->level_count) {
+            schedule->level_count = system->level + 1;
+        }
+    }
+
+    // Counting sort by level, systems of a level keep the order they were added in
+    size_t n = 0;
+    for (size_t level = 0; level < schedule->level_count; level++) {
+        schedule->level_start[level] = n;
+        for (size_t i = 0; i < schedule->count; i++) {
+            if (schedule->systems[i].level == level) {
+                schedule->order[n++] = i;
+            }
+        }
+    }
+    schedule->level_start[schedule->level_count] = n;
+    schedule->built = true;
+}
+
+static void schedule_run_job(void *user_data, size_t index) {
+    const Schedule *schedule = user_data;
+    const System *system = &schedule->systems[schedule->level[index]];
+    system->run(schedule->world);
+}
+
+void schedule_run(Schedule *schedule, JobPool *jobs, void *world) {
+    if (!schedule->built) {
+        schedule_build(schedule);
+    }
+    schedule->world = world;
+    for (size_t level = 0; level < schedule->level_count; level++) {
+        const size_t start = schedule->level_start[level];
+        const size_t count = schedule->level_start[level + 1] - start;
+        if (count == 1) {
+            // Not worth waking the pool for
+            schedule->systems[schedule->order[start]].run(world);
+            continue;
+        }
+        schedule->level = &schedule->order[start];
+        job_pool_run(jobs, count, schedule_run_job, schedule);
+        schedule->parallel_runs += count;
+    }
+    schedule->runs++;
+}
@@ -0,0 +1,53 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "job_pool.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SCHEDULE_MAX_SYSTEMS 32
+
+// Runs a system over `world`, whatever the schedule was run with
+typedef void (*SystemFn)(void *world);
+
+typedef struct {
+    const char *name;
+    SystemFn run;
+    uint32_t reads;  // Resources the system only looks at, bit i is resource i
+    uint32_t writes; // ...and the ones it changes
+    uint32_t after;  // Set by `schedule_build`, systems that have to be done first, bit i is system i
+    size_t level;    // Set by `schedule_build`
+} System;
+
+// Systems and the resources they touch, run level by level with the systems of a level side by side on the job
+// pool. Two systems conflict when one writes something the other reads or writes, the one added later then waits
+// for the earlier one, so the order of `schedule_add` calls is the order the results depend on
+typedef struct {
+    System systems[SCHEDULE_MAX_SYSTEMS];
+    size_t count;
+
+    // Set by `schedule_build`, system indices sorted by level, level i is `order[level_start[i]..level_start[i + 1]]`
+    uint8_t order[SCHEDULE_MAX_SYSTEMS];
+    size_t level_start[SCHEDULE_MAX_SYSTEMS + 1];
+    size_t level_count;
+    bool built;
+
+    // The level being run
+    void *world;
+    const uint8_t *level;
+
+    // Counters for the overlay
+    size_t runs;
+    size_t parallel_runs; // Systems that shared their level with another one
+} Schedule;
+
+Schedule schedule_new();
+// Resources are bits of `reads` and `writes`, what they stand for is up to the caller
+void schedule_add(Schedule *schedule, const char *name, SystemFn run, uint32_t reads, uint32_t writes);
+// Works out what waits for what and the levels, `schedule_run` calls it after systems were added
+void schedule_build(Schedule *schedule);
+// Returns once every system ran. Systems must not run batches of their own on `jobs`
+void schedule_run(Schedule *schedule, JobPool *jobs, void *world);
+
+#endif
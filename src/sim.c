@@ -0,0 +1,165 @@
+#include "sim.h"
+#include "stb_ds_helper.h"
+#include <stb_ds.h>
+#include <stdlib.h>
+
+static void sim_push(Sim *sim, const SimCommand *command) {
+    if (sem_trywait(&sim->free_slots) != 0) {
+        sim->stalls++;
+        while (sem_wait(&sim->free_slots) != 0) {
+        }
+    }
+    const size_t head = atomic_load_explicit(&sim->head, memory_order_relaxed);
+    sim->queue[head % SIM_QUEUE_CAPACITY] = *command;
+    atomic_store_explicit(&sim->head, head + 1, memory_order_release);
+    sem_post(&sim->queued);
+}
+
+static SimCommand sim_pop(Sim *sim) {
+    while (sem_wait(&sim->queued) != 0) {
+    }
+    const size_t tail = atomic_load_explicit(&sim->tail, memory_order_relaxed);
+    // Pairs with the release in `sim_push`, the command is fully written once `head` moved past it
+    while (atomic_load_explicit(&sim->head, memory_order_acquire) == tail) {
+    }
+    const SimCommand command = sim->queue[tail % SIM_QUEUE_CAPACITY];
+    atomic_store_explicit(&sim->tail, tail + 1, memory_order_release);
+    sem_post(&sim->free_slots);
+    return command;
+}
+
+static void *sim_thread(void *arg) {
+    Sim *sim = arg;
+    void *user_data = NULL;
+    uint64_t session = 0;
+    // Set once a tick gave the world back, ticks that were already queued after it are dropped
+    bool halted = true;
+    while (true) {
+        const SimCommand command = sim_pop(sim);
+        switch (command.kind) {
+        case SIM_START:
+            user_data = command.user_data;
+            session = command.session;
+            halted = false;
+            break;
+        case SIM_TICK: {
+            if (halted) {
+                break;
+            }
+            WorldSnapshot *snapshot = &sim->snapshots[sim->back];
+            halted = !sim->tick(user_data, &command, snapshot);
+            snapshot->session = session;
+            sim->back = atomic_exchange(&sim->middle, sim->back | SIM_SNAPSHOT_FRESH) & ~SIM_SNAPSHOT_FRESH;
+            break;
+        }
+        case SIM_STOP:
+            halted = true;
+            sem_post(&sim->stopped);
+            break;
+        case SIM_QUIT:
+            return NULL;
+        }
+    }
+}
+
+Sim *sim_new(SimTickFn tick) {
+    Sim *sim = calloc(1, sizeof(Sim));
+    sim->tick = tick;
+    sim->front = 0;
+    atomic_init(&sim->middle, 1);
+    sim->back = 2;
+    atomic_init(&sim->head, 0);
+    atomic_init(&sim->tail, 0);
+    sem_init(&sim->queued, 0, 0);
+    sem_init(&sim->free_slots, 0, SIM_QUEUE_CAPACITY);
+    sem_init(&sim->stopped, 0, 0);
+    pthread_create(&sim->thread, NULL, sim_thread, sim);
+    return sim;
+}
+
+void sim_start(Sim *sim, void *user_data) {
+    sim->session++;
+    sim->running = true;
+    sim_push(sim, &(SimCommand){.kind = SIM_START, .session = sim->session, .user_data = user_data});
+}
+
+void sim_tick(Sim *sim, const InputFrame *input, Camera2D camera, Rectangle view) {
+    sim->ticks++;
+    sim_push(sim, &(SimCommand){
+                      .kind = SIM_TICK,
+                      .session = sim->session,
+                      .input = *input,
+                      .camera = camera,
+                      .view = view,
+                  });
+}
+
+const WorldSnapshot *sim_latest(Sim *sim, bool *fresh) {
+    *fresh = false;
+    if (atomic_load(&sim->middle) & SIM_SNAPSHOT_FRESH) {
+        sim->front = atomic_exchange(&sim->middle, sim->front) & ~SIM_SNAPSHOT_FRESH;
+        *fresh = true;
+    }
+    const WorldSnapshot *snapshot = &sim->snapshots[sim->front];
+    if (snapshot->session != sim->session) {
+        // Left over from an earlier session
+        *fresh = false;
+        return NULL;
+    }
+    return snapshot;
+}
+
+void sim_stop(Sim *sim) {
+    sim_push(sim, &(SimCommand){.kind = SIM_STOP, .session = sim->session});
+    while (sem_wait(&sim->stopped) != 0) {
+    }
+    sim->running = false;
+}
+
+void sim_free(Sim *sim) {
+    sim_push(sim, &(SimCommand){.kind = SIM_QUIT});
+    pthread_join(sim->thread, NULL);
+    sem_destroy(&sim->queued);
+    sem_destroy(&sim->free_slots);
+    sem_destroy(&sim->stopped);
+    for (int i = 0; i < 3; i++) {
+        world_snapshot_free(&sim->snapshots[i]);
+    }
+    free(sim);
+}
+
+void world_snapshot_copy(WorldSnapshot *to, const WorldSnapshot *from) {
+    // The arrays of `to` have to survive the struct copy
+    EnemyWave wave = to->wave;
+    Bullets bullets = to->bullets;
+    Bullets enemy_bullets = to->enemy_bullets;
+    Pickups pickups = to->pickups;
+    CosmeticParticle *cosmetic = to->particles.cosmetic;
+    *to = *from;
+    to->wave = wave;
+    to->bullets = bullets;
+    to->enemy_bullets = enemy_bullets;
+    to->pickups = pickups;
+    to->particles.cosmetic = cosmetic;
+    STB_DS_ARRAY_COPY(to->wave, from->wave);
+    STB_DS_ARRAY_COPY(to->bullets, from->bullets);
+    STB_DS_ARRAY_COPY(to->enemy_bullets, from->enemy_bullets);
+    STB_DS_ARRAY_COPY(to->pickups, from->pickups);
+    STB_DS_ARRAY_COPY(to->particles.cosmetic, from->particles.cosmetic);
+}
+
+size_t world_snapshot_size(const WorldSnapshot *snapshot) {
+    return sizeof(WorldSnapshot) + stbds_arrlen(snapshot->wave) * sizeof(*snapshot->wave) +
+           stbds_arrlen(snapshot->bullets) * sizeof(*snapshot->bullets) +
+           stbds_arrlen(snapshot->enemy_bullets) * sizeof(*snapshot->enemy_bullets) +
+           stbds_arrlen(snapshot->pickups) * sizeof(*snapshot->pickups) +
+           stbds_arrlen(snapshot->particles.cosmetic) * sizeof(*snapshot->particles.cosmetic);
+}
+
+void world_snapshot_free(WorldSnapshot *snapshot) {
+    stbds_arrfree(snapshot->wave);
+    stbds_arrfree(snapshot->bullets);
+    stbds_arrfree(snapshot->enemy_bullets);
+    stbds_arrfree(snapshot->pickups);
+    stbds_arrfree(snapshot->particles.cosmetic);
+}
@@ -0,0 +1,110 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "bullet.h"
+#include "input.h"
+#include "particles.h"
+#include "pickup.h"
+#include "player.h"
+#include "rng.h"
+#include "wave.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Power of two, the main thread waits when the simulation falls this many frames behind
+#define SIM_QUEUE_CAPACITY 8
+#define SIM_SNAPSHOT_FRESH 0x80000000u
+
+// All of the simulation state, copied out of the world after a tick and drawn from. Entities are plain data
+// without pointers, so copying one of these is a handful of memcpys. The arrays belong to the snapshot and keep
+// their capacity from one copy to the next
+typedef struct {
+    ECSPlayer player;
+    EnemyWave wave;
+    Bullets bullets;
+    Bullets enemy_bullets;
+    Pickups pickups;
+    Particles particles;
+    size_t wave_number;
+    double wave_strength;
+    Rng rng;
+    double clock;
+
+    // Counters of the tick schedule, the overlay reads these instead of the schedule the simulation thread runs
+    size_t schedule_levels;
+    size_t schedule_parallel_runs;
+
+    uint64_t session; // Of the `sim_start` it was made after
+    int request;      // What the tick asked of the main thread, a `GamePhase`
+    double input_sampled_at;
+    double consumed_at; // When the tick acted on input, 0 if it didn't
+} WorldSnapshot;
+
+typedef enum {
+    SIM_START,
+    SIM_TICK,
+    SIM_STOP,
+    SIM_QUIT,
+} SimCommandKind;
+
+typedef struct {
+    SimCommandKind kind;
+    uint64_t session;
+    void *user_data;  // SIM_START
+    InputFrame input; // SIM_TICK
+    Camera2D camera;  // SIM_TICK, for mapping the mouse into the world
+    Rectangle view;   // SIM_TICK, what `camera` shows
+} SimCommand;
+
+// Runs one tick and fills `snapshot`, false once the world has to go back to the main thread
+typedef bool (*SimTickFn)(void *user_data, const SimCommand *command, WorldSnapshot *snapshot);
+
+// The simulation thread, owns the world between `sim_start` and `sim_stop` and ticks it once per frame of input
+typedef struct {
+    pthread_t thread;
+    SimTickFn tick;
+
+    // Lock-free ring, the main thread is the only producer and the simulation thread the only consumer. The
+    // semaphores only put a side to sleep when there is nothing for it to do
+    SimCommand queue[SIM_QUEUE_CAPACITY];
+    atomic_size_t head;
+    atomic_size_t tail;
+    sem_t queued;
+    sem_t free_slots;
+    sem_t stopped;
+
+    // Triple buffer, the simulation thread fills `snapshots[back]` and swaps it with `middle`, the main thread
+    // swaps `middle` with `front` whenever it's fresh
+    WorldSnapshot snapshots[3];
+    atomic_uint middle;
+    uint32_t back;
+    uint32_t front;
+
+    // Main thread only
+    bool running;
+    uint64_t session;
+    size_t ticks;
+    size_t stalls; // Frames the main thread had to wait for room in the queue
+} Sim;
+
+Sim *sim_new(SimTickFn tick);
+// Hands the world to the simulation thread, `user_data` goes to every tick
+void sim_start(Sim *sim, void *user_data);
+// Queues a tick with the input of this frame
+void sim_tick(Sim *sim, const InputFrame *input, Camera2D camera, Rectangle view);
+// The newest snapshot of the running session, NULL before its first tick. `fresh` is set when it wasn't
+// returned before
+const WorldSnapshot *sim_latest(Sim *sim, bool *fresh);
+// Returns once the simulation thread let go of the world, queued ticks are dropped
+void sim_stop(Sim *sim);
+void sim_free(Sim *sim);
+// Makes `to` a copy of `from`, reusing the memory `to` already has
+void world_snapshot_copy(WorldSnapshot *to, const WorldSnapshot *from);
+// Total size of the entities in the snapshot
+size_t world_snapshot_size(const WorldSnapshot *snapshot);
+void world_snapshot_free(WorldSnapshot *snapshot);
+
+#endif
@@ -0,0 +1,35 @@
+#include "sounds.h"
+#include <raylib.h>
+#include <stddef.h>
+
+static const char *sound_files[SFX_COUNT] = {
+    [SFX_PLAYER_JUMP] = "assets/sfx/player_jump.wav",
+    [SFX_PISTOL_SHOOT] = "assets/sfx/pistol_shoot.wav",
+    [SFX_AR_SHOOT] = "assets/sfx/ar_shoot.wav",
+    [SFX_ENEMY_HIT] = "assets/sfx/enemy_hit.wav",
+    [SFX_ENEMY_DIE] = "assets/sfx/enemy_die.wav",
+};
+
+static Sound sounds[SFX_COUNT];
+
+void sounds_load() {
+    for (int i = 0; i < SFX_COUNT; i++) {
+        if (sound_files[i] != NULL) {
+            sounds[i] = LoadSound(sound_files[i]);
+        }
+    }
+}
+
+void sounds_unload() {
+    for (int i = 0; i < SFX_COUNT; i++) {
+        if (sound_files[i] != NULL) {
+            UnloadSound(sounds[i]);
+        }
+    }
+}
+
+void sound_play(SoundId id) {
+    if (id > SFX_NONE && id < SFX_COUNT) {
+        PlaySound(sounds[id]);
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef SOUNDS_H
+#define SOUNDS_H
+
+// Sounds entities refer to, by id so the world stays plain data that can be copied and saved
+typedef enum {
+    SFX_NONE = 0,
+    SFX_PLAYER_JUMP,
+    SFX_PISTOL_SHOOT,
+    SFX_AR_SHOOT,
+    SFX_ENEMY_HIT,
+    SFX_ENEMY_DIE,
+    SFX_COUNT,
+} SoundId;
+
+// Needs the audio device
+void sounds_load();
+void sounds_unload();
+void sound_play(SoundId id);
+
+#endif
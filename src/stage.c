@@ -1,7 +1,266 @@
 #include "stage.h"
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
 
-void draw_stage(const Stage *stage) {
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STAGE_X86_KERNELS
+#endif
+
+_Static_assert(STAGE_MAX_PLATFORMS <= 64, "platform overlap masks are 64 bits wide");
+_Static_assert(STAGE_BOUNDS_CAPACITY >= STAGE_MAX_PLATFORMS && STAGE_BOUNDS_CAPACITY % 8 == 0,
+               "platform bounds have to be padded to the vector width");
+
+void draw_stage(const Stage *stage, RectBatch *batch) {
+    if (batch->view.width <= 0) {
+        for (size_t i = 0; i < stage->count; i++) {
+            rect_batch_push(batch, stage->platforms[i], RED);
+        }
+        return;
+    }
+    // The overlap kernel already culls every platform at once
+    uint64_t visible = stage_overlap_mask(stage, batch->view);
+    batch->stats.culled += stage->count - __builtin_popcountll(visible);
+    while (visible) {
+        const size_t i = __builtin_ctzll(visible);
+        visible &= visible - 1;
+        rect_batch_push(batch, stage->platforms[i], RED);
+    }
+}
+
+StageLayer stage_layer_new() {
+    // Revision 0 is never handed out by `stage_bake`, so the first draw always builds the layer
+    return (StageLayer){.batch = rect_batch_new(STAGE_MAX_PLATFORMS), .revision = 0};
+}
+
+void stage_layer_draw(StageLayer *layer, const Stage *stage) {
+    if (layer->revision != stage->revision) {
+        // The layer's batch has no view, so none of the platforms are culled while it is built
+        layer->batch.count = 0;
+        draw_stage(stage, &layer->batch);
+        rect_batch_upload(&layer->batch);
+        layer->revision = stage->revision;
+    }
+    rect_batch_draw(&layer->batch);
+}
+
+void stage_layer_free(StageLayer *layer) {
+    rect_batch_free(&layer->batch);
+}
+
+static void stage_bake_floor(Stage *stage) {
+    StageFloor *floor = &stage->floor;
+    float x0 = INFINITY;
+    float x1 = -INFINITY;
+    for (size_t i = 0; i < stage->count; i++) {
+        x0 = fminf(x0, stage->platforms[i].x);
+        x1 = fmaxf(x1, stage->platforms[i].x + stage->platforms[i].width);
+    }
+    floor->x0 = x0;
+    floor->cell_width = stage->count > 0 ? fmaxf((x1 - x0) / STAGE_FLOOR_CELLS, 1) : 1;
+    memset(floor->count, 0, sizeof(floor->count));
     for (size_t i = 0; i < stage->count; i++) {
-        DrawRectangleRec(stage->platforms[i], RED);
+        const Platform *platform = &stage->platforms[i];
+        const size_t from = (platform->x - x0) / floor->cell_width;
+        const size_t to = (platform->x + platform->width - x0) / floor->cell_width;
+        for (size_t c = from; c <= to && c < STAGE_FLOOR_CELLS; c++) {
+            // Insertion sort, a full column drops its bottom-most surface
+            float *top = floor->top[c];
+            size_t at = floor->count[c] < STAGE_FLOOR_LAYERS ? floor->count[c]++ : STAGE_FLOOR_LAYERS;
+            for (; at > 0 && top[at - 1] > platform->y; at--) {
+                if (at < STAGE_FLOOR_LAYERS) {
+                    top[at] = top[at - 1];
+                }
+            }
+            if (at < STAGE_FLOOR_LAYERS) {
+                top[at] = platform->y;
+            }
+        }
+    }
+}
+
+float stage_floor_below(const Stage *stage, float x, float y) {
+    const float cell = (x - stage->floor.x0) / stage->floor.cell_width;
+    if (!(cell >= 0 && cell < STAGE_FLOOR_CELLS)) {
+        return INFINITY;
+    }
+    const size_t c = cell;
+    for (size_t i = 0; i < stage->floor.count[c]; i++) {
+        if (stage->floor.top[c][i] >= y) {
+            return stage->floor.top[c][i];
+        }
+    }
+    return INFINITY;
+}
+
+void stage_bake(Stage *stage) {
+    static uint32_t last_revision = 0;
+    stage->revision = ++last_revision;
+    stage_bake_floor(stage);
+
+    StageBounds *b = &stage->bounds;
+    for (size_t i = 0; i < STAGE_BOUNDS_CAPACITY; i++) {
+        if (i < stage->count) {
+            b->x0[i] = stage->platforms[i].x;
+            b->y0[i] = stage->platforms[i].y;
+            b->x1[i] = stage->platforms[i].x + stage->platforms[i].width;
+            b->y1[i] = stage->platforms[i].y + stage->platforms[i].height;
+        } else {
+            b->x0[i] = INFINITY;
+            b->y0[i] = INFINITY;
+            b->x1[i] = -INFINITY;
+            b->y1[i] = -INFINITY;
+        }
+    }
+}
+
+static uint64_t overlap_mask_scalar(const StageBounds *b, size_t count, Rectangle box) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (box.x < b->x1[i] && box.x + box.width > b->x0[i] && box.y < b->y1[i] && box.y + box.height > b->y0[i]) {
+            mask |= (uint64_t)1 << i;
+        }
+    }
+    return mask;
+}
+
+#ifdef STAGE_X86_KERNELS
+__attribute__((target("sse2"))) static uint64_t overlap_mask_sse2(const StageBounds *b, size_t count,
+                                                                   Rectangle box) {
+    const __m128 bx0 = _mm_set1_ps(box.x);
+    const __m128 by0 = _mm_set1_ps(box.y);
+    const __m128 bx1 = _mm_set1_ps(box.x + box.width);
+    const __m128 by1 = _mm_set1_ps(box.y + box.height);
+    uint64_t mask = 0;
+    for (size_t i = 0; i < count; i += 4) {
+        const __m128 x = _mm_and_ps(_mm_cmplt_ps(bx0, _mm_loadu_ps(&b->x1[i])),
+                                    _mm_cmpgt_ps(bx1, _mm_loadu_ps(&b->x0[i])));
+        const __m128 y = _mm_and_ps(_mm_cmplt_ps(by0, _mm_loadu_ps(&b->y1[i])),
+                                    _mm_cmpgt_ps(by1, _mm_loadu_ps(&b->y0[i])));
+        mask |= (uint64_t)_mm_movemask_ps(_mm_and_ps(x, y)) << i;
+    }
+    return mask;
+}
+
+__attribute__((target("avx"))) static uint64_t overlap_mask_avx(const StageBounds *b, size_t count, Rectangle box) {
+    const __m256 bx0 = _mm256_set1_ps(box.x);
+    const __m256 by0 = _mm256_set1_ps(box.y);
+    const __m256 bx1 = _mm256_set1_ps(box.x + box.width);
+    const __m256 by1 = _mm256_set1_ps(box.y + box.height);
+    uint64_t mask = 0;
+    for (size_t i = 0; i < count; i += 8) {
+        const __m256 x = _mm256_and_ps(_mm256_cmp_ps(bx0, _mm256_loadu_ps(&b->x1[i]), _CMP_LT_OQ),
+                                       _mm256_cmp_ps(bx1, _mm256_loadu_ps(&b->x0[i]), _CMP_GT_OQ));
+        const __m256 y = _mm256_and_ps(_mm256_cmp_ps(by0, _mm256_loadu_ps(&b->y1[i]), _CMP_LT_OQ),
+                                       _mm256_cmp_ps(by1, _mm256_loadu_ps(&b->y0[i]), _CMP_GT_OQ));
+        mask |= (uint64_t)_mm256_movemask_ps(_mm256_and_ps(x, y)) << i;
+    }
+    return mask;
+}
+#endif
+
+typedef uint64_t (*OverlapMaskKernel)(const StageBounds *b, size_t count, Rectangle box);
+
+static OverlapMaskKernel select_overlap_mask_kernel(void) {
+#ifdef STAGE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+        return overlap_mask_avx;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return overlap_mask_sse2;
+    }
+#endif
+    return overlap_mask_scalar;
+}
+
+// Picked once, the renderer and the simulation thread may both be first to ask
+static OverlapMaskKernel overlap_mask_kernel;
+static pthread_once_t overlap_mask_kernel_once = PTHREAD_ONCE_INIT;
+
+static void init_overlap_mask_kernel() {
+    overlap_mask_kernel = select_overlap_mask_kernel();
+}
+
+uint64_t stage_overlap_mask(const Stage *stage, Rectangle box) {
+    pthread_once(&overlap_mask_kernel_once, init_overlap_mask_kernel);
+    return overlap_mask_kernel(&stage->bounds, stage->count, box);
+}
+
+// Fractions of `d` at which the moving span [a0, a1] starts and stops overlapping the static span [b0, b1]
+static bool sweep_axis(float a0, float a1, float b0, float b1, float d, float *enter, float *exit) {
+    if (d == 0) {
+        *enter = -INFINITY;
+        *exit = INFINITY;
+        return a0 < b1 && a1 > b0;
+    }
+    const float t0 = (b0 - a1) / d;
+    const float t1 = (b1 - a0) / d;
+    *enter = fminf(t0, t1);
+    *exit = fmaxf(t0, t1);
+    return true;
+}
+
+// Resting contacts come out a hair inside the platform due to rounding, those still count as touching
+#define STAGE_SKIN 0.01f
+
+static bool sweep_platform(Rectangle rect, Vector2 delta, const Platform *platform, float max_t, StageHit *hit) {
+    float enter_x, exit_x, enter_y, exit_y;
+    if (!sweep_axis(rect.x, rect.x + rect.width, platform->x, platform->x + platform->width, delta.x, &enter_x,
+                    &exit_x) ||
+        !sweep_axis(rect.y, rect.y + rect.height, platform->y, platform->y + platform->height, delta.y, &enter_y,
+                    &exit_y)) {
+        return false;
+    }
+    float enter = fmaxf(enter_x, enter_y);
+    const float exit = fminf(exit_x, exit_y);
+    const float speed = enter_x > enter_y ? fabsf(delta.x) : fabsf(delta.y);
+    if (enter < 0 && -enter * speed <= STAGE_SKIN) {
+        enter = 0;
+    }
+    if (enter >= exit || enter < 0 || enter > max_t) {
+        return false;
+    }
+    hit->t = enter;
+    if (enter_x > enter_y) {
+        hit->normal = (Vector2){delta.x > 0 ? -1 : 1, 0};
+    } else {
+        hit->normal = (Vector2){0, delta.y > 0 ? -1 : 1};
+    }
+    return true;
+}
+
+bool stage_sweep_rect(const Stage *stage, Rectangle rect, Vector2 delta, size_t first, StageHit *hit) {
+    bool found = false;
+    hit->t = 1.0f;
+    if (first < stage->count && sweep_platform(rect, delta, &stage->platforms[first], hit->t, hit)) {
+        hit->platform = first;
+        found = true;
+        // Nothing can be touched earlier than right away
+        if (hit->t == 0) {
+            return true;
+        }
+    }
+
+    // Only platforms overlapping the area swept over can be touched
+    const Rectangle swept = {
+        .x = fminf(rect.x, rect.x + delta.x) - STAGE_SKIN,
+        .y = fminf(rect.y, rect.y + delta.y) - STAGE_SKIN,
+        .width = rect.width + fabsf(delta.x) + STAGE_SKIN * 2,
+        .height = rect.height + fabsf(delta.y) + STAGE_SKIN * 2,
+    };
+    uint64_t candidates = stage_overlap_mask(stage, swept);
+    if (first < stage->count) {
+        candidates &= ~((uint64_t)1 << first);
+    }
+    while (candidates != 0) {
+        const size_t i = __builtin_ctzll(candidates);
+        candidates &= candidates - 1;
+        if (sweep_platform(rect, delta, &stage->platforms[i], hit->t, hit)) {
+            hit->platform = i;
+            found = true;
+        }
     }
+    return found;
 }
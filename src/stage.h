@@ -1,17 +1,79 @@
 #ifndef STAGE_H
 #define STAGE_H
+#include "render.h"
 #include <raylib.h>
 #include <stddef.h>
+#include <stdint.h>
 typedef Rectangle Platform;
 
+#define STAGE_MAX_PLATFORMS 50
+// Rounded up to a multiple of the widest vector the overlap kernels use (8 floats)
+#define STAGE_BOUNDS_CAPACITY 56
+
+// Platform bounds split into separate arrays so a box can be tested against several platforms at once
+// The padding past `count` never overlaps anything
+typedef struct {
+    float x0[STAGE_BOUNDS_CAPACITY];
+    float y0[STAGE_BOUNDS_CAPACITY];
+    float x1[STAGE_BOUNDS_CAPACITY];
+    float y1[STAGE_BOUNDS_CAPACITY];
+} StageBounds;
+
+#define STAGE_FLOOR_CELLS 512
+#define STAGE_FLOOR_LAYERS 8
+
+// Platform surfaces per column of the stage, top-most first, good enough for things that only need to look like
+// they land
+typedef struct {
+    float x0;
+    float cell_width;
+    uint8_t count[STAGE_FLOOR_CELLS];
+    float top[STAGE_FLOOR_CELLS][STAGE_FLOOR_LAYERS]; // Sorted, only the first `count` of a column are set
+} StageFloor;
+
 // TODO: Environment hazards (lava, water, air drafts)
 typedef struct {
     Vector2 spawn;
-    Platform platforms[50];
+    Platform platforms[STAGE_MAX_PLATFORMS];
     Platform spawns[20];
     size_t count;
     size_t count_sp;
+    StageBounds bounds;
+    StageFloor floor;
+    uint32_t revision; // Changes every time the stage is baked, caches built from it compare against this
 } Stage;
 
-void draw_stage(const Stage *stage);
+// The platforms of a stage kept in a vertex buffer, only rebuilt when the stage it was built from changes
+typedef struct {
+    RectBatch batch;
+    uint32_t revision;
+} StageLayer;
+
+typedef struct {
+    float t;        // Fraction of the displacement covered before touching, in [0, 1]
+    Vector2 normal; // Normal of the touched platform face
+    size_t platform;
+} StageHit;
+
+void draw_stage(const Stage *stage, RectBatch *batch);
+
+StageLayer stage_layer_new();
+// Draws `stage` with a single draw, rebuilding the layer first if `stage` was baked since
+void stage_layer_draw(StageLayer *layer, const Stage *stage);
+void stage_layer_free(StageLayer *layer);
+
+// Rebuilds everything derived from `platforms`, has to be called after they change
+void stage_bake(Stage *stage);
+
+// Height of the first platform surface at `x` that is at or below `y`, INFINITY if there is none
+float stage_floor_below(const Stage *stage, float x, float y);
+
+// Bitmask of the platforms overlapping `box` (bit i is `platforms[i]`), the same test as `CheckCollisionRecs`
+// Uses SSE2 or AVX depending on what the CPU supports
+uint64_t stage_overlap_mask(const Stage *stage, Rectangle box);
+
+// Sweeps `rect` along `delta` and reports the first platform it would touch
+// Platforms `rect` already overlaps are ignored so that things stuck inside one can still move out
+// `first` is tested before the others (pass `stage->count` to not hint anything)
+bool stage_sweep_rect(const Stage *stage, Rectangle rect, Vector2 delta, size_t first, StageHit *hit);
 #endif
@@ -2,6 +2,13 @@
 #define STATIC_CONFIG_H
 
 #define G 500
+// Horizontal velocity decays by this factor per second
+#define DRAG 10
+#define MAX_FALL_SPEED 800
 #define INVULNERABILITY_TIME 0.5
+// The playfield is rendered at 1/PLAYFIELD_SCALE of the screen resolution and upscaled with nearest neighbour
+// filtering, at 1 it is rendered at full resolution and pixelized by a shader instead
+#define PLAYFIELD_SCALE 2
+#define PLAYFIELD_MAX_SCALE 4
 
 #endif
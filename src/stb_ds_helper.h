@@ -1,6 +1,7 @@
 #ifndef STB_DS_HELPER_H
 #define STB_DS_HELPER_H
 #include <stb_ds.h>
+#include <string.h>
 #define STB_DS_ARRAY_CLEAN(array, condition) \
     for (ptrdiff_t i = stbds_arrlen(array) - 1; i >= 0; i--) {\
         if (condition) {\
@@ -8,4 +9,14 @@
         }\
     }
 #define STB_DS_ARRAY_RESET(array) stbds_arrsetlen(array, 0)
+// Makes `array` hold the `count` elements at `elements`, keeping the memory it already has when it's big enough
+#define STB_DS_ARRAY_ASSIGN(array, elements, count) \
+    do {\
+        stbds_arrsetlen(array, count); \
+        if ((count) > 0) {\
+            memcpy(array, elements, (count) * sizeof(*(array))); \
+        }\
+    } while (0)
+// Makes `to` a copy of `from`
+#define STB_DS_ARRAY_COPY(to, from) STB_DS_ARRAY_ASSIGN(to, from, stbds_arrlen(from))
 #endif
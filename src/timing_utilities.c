@@ -4,3 +4,36 @@
 double time_delta(double t) {
     return GetTime() - t;
 }
+
+// Per thread, the simulation thread gets the frame time of the input it runs on, see `frame_time_set`
+static _Thread_local double frame_started_at;
+static _Thread_local float frame_dt;
+static _Thread_local double world_now;
+
+float frame_time() {
+    return frame_dt;
+}
+
+void frame_time_tick() {
+    const double now = GetTime();
+    if (frame_started_at > 0) {
+        frame_dt = now - frame_started_at;
+    }
+    frame_started_at = now;
+}
+
+void frame_time_set(float dt) {
+    frame_dt = dt;
+}
+
+double world_time() {
+    return world_now;
+}
+
+double world_time_since(double t) {
+    return world_now - t;
+}
+
+void world_time_set(double t) {
+    world_now = t;
+}
@@ -5,4 +5,20 @@
 // NOTE: InitWindow() has to be called before calling this function
 double time_delta(double t);
 
+// Seconds between the starts of the last two frames. Use this instead of raylib's GetFrameTime(), which only
+// measures anything when raylib paces the frames itself
+float frame_time();
+// Marks the start of a frame, called by `pacing_begin_frame`
+void frame_time_tick();
+// What `frame_time` returns on the calling thread, for threads that run frames they don't pace themselves
+void frame_time_set(float dt);
+
+// The simulation clock of the world the calling thread works on, entity timestamps are taken from it. It only
+// advances with ticks, pauses and savestates don't age anything
+double world_time();
+// Seconds between `t` and `world_time()`
+double world_time_since(double t);
+// What `world_time` returns on the calling thread, set before ticking or drawing a world
+void world_time_set(double t);
+
 #endif
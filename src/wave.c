@@ -12,12 +12,12 @@ bool wave_is_done(const EnemyWave *wave) {
     return true;
 }
 
-void wave_draw(const EnemyWave *wave) {
+void wave_draw(const EnemyWave *wave, RectBatch *batch) {
     for (ptrdiff_t i = 0; i < stbds_arrlen(*wave); i++) {
         const ECSEnemy *enemy = &(*wave)[i];
-        if (!enemy->state.dead) {
-            enemy_draw_self(enemy);
-            enemy_draw_health_bar(enemy);
+        if (!enemy->state.dead && rect_batch_visible(batch, enemy_draw_bounds(enemy))) {
+            enemy_draw_self(enemy, batch);
+            enemy_draw_health_bar(enemy, batch);
         }
     }
 }
@@ -8,6 +8,6 @@
 typedef ECSEnemy* EnemyWave;
 
 bool wave_is_done(const EnemyWave* wave);
-void wave_draw(const EnemyWave* wave);
+void wave_draw(const EnemyWave* wave, RectBatch *batch);
 
 #endif
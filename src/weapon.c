@@ -1,35 +1,19 @@
 #include "weapon.h"
 #include "ecs.h"
+#include "input.h"
 #include "timing_utilities.h"
 #include <raylib.h>
 #include <raymath.h>
 
-void pistol_try_shoot(struct Weapon *this, Bullets *bullets, const TransformComp *from, const Camera2D *camera) {
-    if (time_delta(this->last_shot) > this->fire_rate) {
-        const Vector2 mouse_pos = GetScreenToWorld2D(GetMousePosition(), *camera);
-        const Vector2 dir = Vector2Normalize(Vector2Subtract(mouse_pos, transform_center(from)));
-        bullets_spawn_bullet(bullets, this->create_bullet(this, transform_center(from), PURPLE, dir));
-        this->last_shot = GetTime();
-        PlaySound(this->shoot_sound);
-    }
-}
-
-void pistol_on_hit(Bullet *this, PhysicsComp *victim_physics, HealthComp *victim_health) {
-    victim_health->current -= this->damage;
-    this->active = false;
-    victim_physics->velocity.x += 200 * this->direction.x;
-    victim_physics->velocity.y += 200 * this->direction.y;
-}
-
-Bullet pistol_create_bullet(Weapon *pistol, Vector2 pos, Color c, Vector2 dir) {
+static Bullet pistol_create_bullet(const Weapon *pistol, Vector2 pos, Color c, Vector2 dir) {
     return (Bullet){
         .direction = dir,
-        .creation_time = GetTime(),
+        .creation_time = world_time(),
         .transform = TRANSFORM(pos.x, pos.y, 16, 8),
         .draw_conf = {.color = c},
         .damage = pistol->damage,
         .active = true,
-        .on_hit = pistol_on_hit,
+        .kind = BK_PISTOL,
         .speed = 900,
     };
 }
@@ -40,9 +24,7 @@ Weapon create_pistol() {
         .last_shot = 0.0,
         .fire_rate = 0.5,
         .damage = 4,
-        .shoot_sound = LoadSound("assets/sfx/pistol_shoot.wav"),
-        .try_shoot = pistol_try_shoot,
-        .create_bullet = pistol_create_bullet,
+        .shoot_sound = SFX_PISTOL_SHOOT,
         .damage_upgrade_cost = 2,
         .fire_rate_upgrade_cost = 4,
     };
@@ -53,9 +35,7 @@ Weapon create_ar() {
         .last_shot = 0.0,
         .fire_rate = .25,
         .damage = 2,
-        .shoot_sound = LoadSound("assets/sfx/ar_shoot.wav"),
-        .try_shoot = ar_try_shoot,
-        .create_bullet = ar_create_bullet,
+        .shoot_sound = SFX_AR_SHOOT,
         .damage_upgrade_cost = 3,
         .fire_rate_upgrade_cost = 5,
     };
@@ -67,73 +47,60 @@ Weapon create_shotgun() {
         .last_shot = 0.0,
         .fire_rate = 1,
         .damage = 5,
-        .shoot_sound = LoadSound("assets/sfx/ar_shoot.wav"),
-        .try_shoot = shotgun_try_shoot,
-        .create_bullet = shotgun_create_bullet,
+        .shoot_sound = SFX_AR_SHOOT,
         .damage_upgrade_cost = 4,
         .fire_rate_upgrade_cost = 5,
     };
 }
 
-void ar_try_shoot(struct Weapon *this, Bullets *bullets, const TransformComp *from, const Camera2D *camera) {
-    if (time_delta(this->last_shot) > this->fire_rate) {
-        const Vector2 mouse_pos = GetScreenToWorld2D(GetMousePosition(), *camera);
-        const Vector2 dir = Vector2Normalize(Vector2Subtract(mouse_pos, transform_center(from)));
-        bullets_spawn_bullet(bullets, this->create_bullet(this, transform_center(from), PURPLE, dir));
-        this->last_shot = GetTime();
-        PlaySound(this->shoot_sound);
-    }
-}
-
-void ar_on_hit(Bullet *this, PhysicsComp *victim_physics, HealthComp *victim_health) {
-    victim_health->current -= this->damage;
-    this->active = false;
-    victim_physics->velocity.x += 100 * this->direction.x;
-    victim_physics->velocity.y += 100 * this->direction.y;
-}
-
-Bullet ar_create_bullet(Weapon *ar, Vector2 pos, Color c, Vector2 dir) {
+static Bullet ar_create_bullet(const Weapon *ar, Vector2 pos, Color c, Vector2 dir) {
     return (Bullet){
         .direction = dir,
-        .creation_time = GetTime(),
+        .creation_time = world_time(),
         .transform = TRANSFORM(pos.x, pos.y, 8, 4),
         .draw_conf = {.color = c},
         .damage = ar->damage,
         .active = true,
-        .on_hit = ar_on_hit,
+        .kind = BK_AR,
         .speed = 1500,
     };
 }
 
-void shotgun_try_shoot(struct Weapon *this, Bullets *bullets, const TransformComp *from, const Camera2D *camera) {
-    if (time_delta(this->last_shot) > this->fire_rate) {
-        const Vector2 mouse_pos = GetScreenToWorld2D(GetMousePosition(), *camera);
-        for (size_t i = 0; i < 5; i++) {
-            const Vector2 dir = Vector2Rotate(Vector2Normalize(Vector2Subtract(mouse_pos, transform_center(from))),
-                                              GetRandomValue(-15, 15) * DEG2RAD);
-            bullets_spawn_bullet(bullets, this->create_bullet(this, transform_center(from), PURPLE, dir));
-        }
-        this->last_shot = GetTime();
-        PlaySound(this->shoot_sound);
-    }
-}
-
-void shotgun_on_hit(Bullet *this, PhysicsComp *victim_physics, HealthComp *victim_health) {
-    victim_health->current -= this->damage;
-    this->active = false;
-    victim_physics->velocity.x += 100 * this->direction.x;
-    victim_physics->velocity.y += 100 * this->direction.y;
-}
-
-Bullet shotgun_create_bullet(Weapon *shotgun, Vector2 pos, Color c, Vector2 dir) {
+static Bullet shotgun_create_bullet(const Weapon *shotgun, Vector2 pos, Color c, Vector2 dir) {
     return (Bullet){
         .direction = dir,
-        .creation_time = GetTime(),
+        .creation_time = world_time(),
         .transform = TRANSFORM(pos.x, pos.y, 8, 8),
         .draw_conf = {.color = c},
         .damage = shotgun->damage,
         .active = true,
-        .on_hit = shotgun_on_hit,
+        .kind = BK_SHOTGUN,
         .speed = 1500,
     };
 }
+
+void weapon_try_shoot(Weapon *weapon, Bullets *bullets, const TransformComp *from, const Camera2D *camera, Rng *rng) {
+    if (world_time_since(weapon->last_shot) <= weapon->fire_rate) {
+        return;
+    }
+    const Vector2 mouse_pos = GetScreenToWorld2D(input_mouse_position(), *camera);
+    const Vector2 dir = Vector2Normalize(Vector2Subtract(mouse_pos, transform_center(from)));
+    switch (weapon->type) {
+    case WT_PISTOL:
+        bullets_spawn_bullet(bullets, pistol_create_bullet(weapon, transform_center(from), PURPLE, dir));
+        break;
+    case WT_AR:
+        bullets_spawn_bullet(bullets, ar_create_bullet(weapon, transform_center(from), PURPLE, dir));
+        break;
+    case WT_SHOTGUN:
+        for (size_t i = 0; i < 5; i++) {
+            const Vector2 pellet_dir = Vector2Rotate(dir, rng_range(rng, -15, 15) * DEG2RAD);
+            bullets_spawn_bullet(bullets, shotgun_create_bullet(weapon, transform_center(from), PURPLE, pellet_dir));
+        }
+        break;
+    case WT_COUNT:
+        return;
+    }
+    weapon->last_shot = world_time();
+    sound_play(weapon->shoot_sound);
+}